@@ -27,7 +27,10 @@ enum class NodeType {
     FloatLiteral,
     BoolLiteral,
     StringLiteral,
-    FunctionCall
+    FunctionCall,
+    Import,
+    Label,
+    Goto
 };
 
 enum class VarType {
@@ -45,6 +48,7 @@ class ASTNode {
 public:
     NodeType type;
     VarType valueType = VarType::Int;
+    int line = 0;  // source line (yylineno), 0 if unknown
 
     int intVal = 0;
     float floatVal = 0.0f;
@@ -64,6 +68,12 @@ public:
     ASTNode(NodeType type, const string& op, shared_ptr<ASTNode> lhs, shared_ptr<ASTNode> rhs);
     ASTNode(NodeType type, const vector<shared_ptr<ASTNode>>& children);
 
+    // Releases subtrees iteratively so very deep trees can't overflow the stack
+    ~ASTNode();
+
+    // Deep copy of this subtree, made without recursion
+    shared_ptr<ASTNode> clone() const;
+
     // Utilities
     void print(int indent = 0) const;
     string getLiteralAsString() const;
@@ -2,9 +2,13 @@
 #define CODEGEN_H
 
 #include "ast.h"
+#include "module.h"
+#include "profiler.h"
 #include <string>
 #include <memory>
+#include <fstream>
 #include <ostream>
+#include <vector>
 
 using namespace std;
 
@@ -16,10 +20,43 @@ public:
     // Generate C code from the root AST and write to file
     void generate(const shared_ptr<ASTNode>& root, const string& outputFile);
 
+    // Declare a function defined in an imported module (emitted as a prototype)
+    void declareExtern(const FunctionSignature& signature);
+
+    // Streaming mode: open the output, emit top-level statements as they are
+    // parsed, then finish. Function prototypes go straight to `declsFile`
+    // (externs are appended at the end); the output includes it up front so
+    // calls may still precede definitions.
+    bool begin(const string& outputFile, const string& declsFile);
+    void emitTopLevel(const shared_ptr<ASTNode>& node);
+    void finish();
+
+    // Instrument every function and loop with counters and timers keyed to
+    // their source line; the program writes its profile when it exits
+    void enableProfiling(const string& reportFile, const string& foldedFile);
+
 private:
+    vector<FunctionSignature> externs;
+
+    ofstream stream;
+    ofstream decls;
+
+    bool profiling = false;
+    string profileReport;
+    string profileFolded;
+    vector<ProfileSite> profileSites;
+    int functionSite = -1;  // site of the function currently being generated
+    string functionReturnType;
+
+    struct Task;
+    class Emitter;
+
     void generateNode(const shared_ptr<ASTNode>& node, ostream& out);
-    void generateStatement(const shared_ptr<ASTNode>& node, ostream& out);
-    void generateExpression(const shared_ptr<ASTNode>& node, ostream& out);
+    void expandStatement(const shared_ptr<ASTNode>& node, Emitter& emit);
+    void expandExpression(const shared_ptr<ASTNode>& node, bool bare, Emitter& emit);
+
+    int addProfileSite(const string& kind, const shared_ptr<ASTNode>& loop, Emitter& emit);
+    void profileLoopBody(int site, const shared_ptr<ASTNode>& body, Emitter& emit);
 };
 
 #endif // CODEGEN_H
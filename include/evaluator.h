@@ -0,0 +1,57 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "ast.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+// Compile-time interpreter for pure functions.
+// A function is pure if it doesn't print, only touches its own parameters and
+// locals, and only calls other pure functions. Evaluation follows the semantics
+// of the generated C (32-bit ints) and gives up on anything it can't reproduce
+// exactly: floats, strings, overflow, division by zero or exceeding its budget.
+class ConstEvaluator {
+public:
+    explicit ConstEvaluator(long stepBudget);
+
+    // Register the functions of a program (the main one or an imported module)
+    void addFunctions(const shared_ptr<ASTNode>& program);
+
+    // Determine which registered functions are pure; call after adding all functions
+    void analyzePurity();
+
+    bool isPure(const string& name) const;
+
+    // Evaluate a call with constant arguments. Returns false if it can't be folded.
+    bool evaluate(const string& name, const vector<int>& args, int& result, long& steps);
+
+private:
+    enum class Flow {
+        Normal,
+        Returned,
+        Failed
+    };
+
+    struct Frame {
+        vector<unordered_map<string, int>> scopes;
+        int returnValue = 0;
+    };
+
+    long stepBudget;
+    long steps = 0;
+    int depth = 0;
+    unordered_map<string, shared_ptr<ASTNode>> functions;
+    unordered_set<string> pure;
+
+    bool call(const string& name, const vector<int>& args, int& result);
+    Flow execute(const shared_ptr<ASTNode>& node, Frame& frame);
+    bool eval(const shared_ptr<ASTNode>& node, Frame& frame, int& value);
+    bool tick();
+};
+
+#endif // EVALUATOR_H
@@ -1,21 +1,29 @@
 #ifndef LEXER_H
 #define LEXER_H
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+#include <cstdio>
+#include <ostream>
+#include <string>
 
-// Lexical analyzer function provided by Flex
+// Lexical analyzer function, provided by Flex (lexer.l) or, when built with
+// BAC_HANDWRITTEN_LEXER, by the hand-written scanner (scanner.cpp)
 int yylex();
 
 // Error handling function used by Bison
-void yyerror(const char* msg);
+int yyerror(const char* msg);
 
-// Flex sets this to keep track of line numbers
+// Input file and current line number of the lexer
+extern FILE* yyin;
 extern int yylineno;
 
-#ifdef __cplusplus
-}
-#endif
+// Name of a token as declared in parser.y, e.g. "IDENTIFIER"
+const char* tokenName(int token);
+
+// Lex all of yyin, writing one token per line with its line number and value.
+// Used to check that both lexers produce the same token stream.
+void dumpTokens(std::ostream& out);
+
+// Lex the file repeatedly for about a second and report tokens per second
+bool benchmarkLexer(const std::string& path);
 
 #endif // LEXER_H
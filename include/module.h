@@ -0,0 +1,86 @@
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "ast.h"
+
+using namespace std;
+
+// Signature of a function exported by a module
+struct FunctionSignature {
+    string name;
+    VarType returnType = VarType::Int;
+    vector<VarType> paramTypes;
+    vector<string> paramNames;
+};
+
+// A module this one was built against, and the hash of its source at the time
+struct ModuleDependency {
+    string sourcePath;
+    uint64_t sourceHash = 0;
+
+    bool operator==(const ModuleDependency& other) const
+    {
+        return sourcePath == other.sourcePath && sourceHash == other.sourceHash;
+    }
+};
+
+// A loaded module: its exported symbols, AST and the object file to link
+struct Module {
+    string sourcePath;
+    string objectPath;
+    uint64_t sourceHash = 0;
+    vector<ModuleDependency> dependencies;  // direct and transitive imports
+    vector<FunctionSignature> exports;
+    shared_ptr<ASTNode> ast;
+};
+
+// Resolves `import "lib.bac";` statements into precompiled `.bacm` modules.
+// A module is rebuilt whenever the hash of its source, or of any module it
+// imports, no longer matches the one stored in its `.bacm` file (calls into
+// imports may have been folded into its object code); otherwise it is loaded
+// without reparsing.
+class ModuleLoader {
+public:
+    explicit ModuleLoader(const string& outputDir);
+
+    // Load every module imported by the given program, including transitive imports.
+    // `importerPath` is used to resolve relative import paths.
+    bool loadImports(const shared_ptr<ASTNode>& program, const string& importerPath);
+
+    // Modules in dependency order (dependencies before their importers)
+    const vector<Module>& modules() const { return loaded; }
+
+    // A copy of the module's AST optimized against its dependencies, as compiled into its object file
+    shared_ptr<ASTNode> optimizedAst(const Module& module) const;
+
+private:
+    string outputDir;
+    vector<Module> loaded;
+    vector<string> loading;  // modules whose imports are being loaded, outermost first
+
+    bool loadModule(const string& sourcePath);
+    const Module* findLoaded(const string& sourcePath) const;
+    vector<ModuleDependency> dependenciesOf(const shared_ptr<ASTNode>& program, const string& importerPath) const;
+    // `artifactBase` is the output path without extension for the .bacm, .c and .o files
+    bool buildModule(const string& sourcePath, uint64_t hash, const string& artifactBase, Module& module);
+};
+
+// Hash of a file's contents (FNV-1a, 64 bit). Returns 0 if the file cannot be read.
+uint64_t hashFile(const string& path);
+
+// Signature of a single Function node
+FunctionSignature signatureOf(const shared_ptr<ASTNode>& function);
+
+// Collect the signatures of all top-level functions in a program
+vector<FunctionSignature> collectExports(const shared_ptr<ASTNode>& program);
+
+// Binary (de)serialization of a module in the `.bacm` format
+bool writeModuleFile(const string& path, const Module& module);
+bool readModuleFile(const string& path, Module& module);
+
+#endif // MODULE_H
@@ -0,0 +1,39 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "ast.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// AST-to-AST optimization passes, run after parsing and before code generation
+class Optimizer {
+public:
+    Optimizer();
+
+    // Make an imported module's functions available for compile-time evaluation
+    void addLibrary(const shared_ptr<ASTNode>& module);
+
+    // Run all passes over the program, rewriting it in place
+    void optimize(const shared_ptr<ASTNode>& program);
+
+    // Run the passes that only need a single top-level statement (streaming mode).
+    // Compile-time evaluation is skipped since it needs every function body.
+    void optimizeStatement(const shared_ptr<ASTNode>& statement);
+
+private:
+    vector<shared_ptr<ASTNode>> libraries;
+
+    // Replace calls to pure functions with constant arguments by their result
+    int foldPureCalls(const shared_ptr<ASTNode>& program);
+
+    // Turn long `a + b + c + ...`, `a - b - c - ...` and `a * b * c * ...` chains into balanced trees
+    int rebalanceChains(const shared_ptr<ASTNode>& program);
+
+    // Rewrite self tail calls (and safe accumulator recursion) into loops
+    bool eliminateTailCalls(const shared_ptr<ASTNode>& function);
+};
+
+#endif // OPTIMIZER_H
@@ -1,6 +1,7 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <functional>
 #include <memory>
 #include "ast.h"
 
@@ -8,6 +9,10 @@
 // This will be assigned by the parser (see parser.y)
 extern std::shared_ptr<ASTNode> root;
 
+// Called with each top-level statement as soon as it is parsed. Returning true
+// means the statement was consumed (streaming mode) and is not kept in `root`.
+extern std::function<bool(const std::shared_ptr<ASTNode>&)> onTopLevelStatement;
+
 // The parser function generated by Bison
 int yyparse();
 
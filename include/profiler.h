@@ -0,0 +1,25 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// An instrumented function or loop in the generated program
+struct ProfileSite {
+    string name;  // function name, or e.g. "while@12" for loops
+    string kind;  // "function" or "loop"
+    int line;
+};
+
+// Emits the C runtime used by instrumented code: bac_prof_enter/leave/unwind
+// and an exit handler (bac_prof_report) that writes a report of sites sorted by
+// self time to `reportFile` and a flamegraph-compatible folded-stack file.
+void writeProfilerRuntime(ostream& out, const string& reportFile, const string& foldedFile);
+
+// Emits the table describing every site; must follow all instrumented code
+void writeProfilerSites(ostream& out, const vector<ProfileSite>& sites);
+
+#endif // PROFILER_H
@@ -44,7 +44,12 @@ public:
 
 private:
     int currentScope = 0;
-    vector<unordered_map<string, shared_ptr<SymbolInfo>>> scopes;
+
+    // Visible bindings per name, innermost last, so lookups don't scan every scope
+    unordered_map<string, vector<shared_ptr<SymbolInfo>>> bindings;
+
+    // Names declared in each open scope, removed from `bindings` on exit
+    vector<vector<string>> scopes;
 };
 
 #endif // SYMBOLTABLE_H
@@ -1,6 +1,7 @@
 // Abstract Syntax Tree (AST) implementation
 #include "ast.h"
 #include <iostream>
+#include <utility>
 
 using namespace std;
 
@@ -39,6 +40,123 @@ ASTNode::ASTNode(NodeType type, const string &op,
 ASTNode::ASTNode(NodeType type, const vector<shared_ptr<ASTNode>> &children)
     : type(type), children(children) {}
 
+// Destroys the subtree without recursing: children whose last owner is this
+// node are detached onto a work list before they are released
+ASTNode::~ASTNode()
+{
+    vector<shared_ptr<ASTNode>> pending;
+    pending.push_back(move(left));
+    pending.push_back(move(right));
+    for (auto &child : children)
+        pending.push_back(move(child));
+
+    while (!pending.empty())
+    {
+        shared_ptr<ASTNode> node = move(pending.back());
+        pending.pop_back();
+
+        if (node && node.use_count() == 1)
+        {
+            pending.push_back(move(node->left));
+            pending.push_back(move(node->right));
+            for (auto &child : node->children)
+                pending.push_back(move(child));
+            node->children.clear();
+        }
+    }
+}
+
+// Copies a node's own fields; its subtrees are filled in by clone()
+static shared_ptr<ASTNode> copyFields(const ASTNode &node)
+{
+    auto copy = make_shared<ASTNode>(node.type);
+    copy->valueType = node.valueType;
+    copy->line = node.line;
+    copy->intVal = node.intVal;
+    copy->floatVal = node.floatVal;
+    copy->boolVal = node.boolVal;
+    copy->strVal = node.strVal;
+    return copy;
+}
+
+shared_ptr<ASTNode> ASTNode::clone() const
+{
+    auto result = copyFields(*this);
+    vector<pair<const ASTNode *, ASTNode *>> pending = {{this, result.get()}};
+
+    while (!pending.empty())
+    {
+        auto [source, target] = pending.back();
+        pending.pop_back();
+
+        if (source->left)
+        {
+            target->left = copyFields(*source->left);
+            pending.push_back({source->left.get(), target->left.get()});
+        }
+        if (source->right)
+        {
+            target->right = copyFields(*source->right);
+            pending.push_back({source->right.get(), target->right.get()});
+        }
+        for (const auto &child : source->children)
+        {
+            target->children.push_back(child ? copyFields(*child) : nullptr);
+            if (child)
+                pending.push_back({child.get(), target->children.back().get()});
+        }
+    }
+    return result;
+}
+
+// Returns the value of a literal node as source text
+string ASTNode::getLiteralAsString() const
+{
+    switch (type)
+    {
+    case NodeType::IntLiteral:
+        return to_string(intVal);
+    case NodeType::FloatLiteral:
+        return to_string(floatVal);
+    case NodeType::BoolLiteral:
+        return boolVal ? "true" : "false";
+    case NodeType::StringLiteral:
+        return "\"" + strVal + "\"";
+    default:
+        return strVal;
+    }
+}
+
+// Prints the tree for debugging, using an explicit stack rather than recursion
+void ASTNode::print(int indent) const
+{
+    vector<pair<const ASTNode *, int>> pending;
+    pending.push_back({this, indent});
+
+    while (!pending.empty())
+    {
+        auto [node, depth] = pending.back();
+        pending.pop_back();
+
+        cout << string(depth, ' ') << nodeTypeToString(node->type);
+        string value = node->getLiteralAsString();
+        if (!value.empty())
+            cout << ": " << value;
+        cout << '\n';
+
+        // Pushed in reverse so they print left, right, then children in order
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+        {
+            if (*it)
+                pending.push_back({it->get(), depth + 2});
+        }
+        if (node->right)
+            pending.push_back({node->right.get(), depth + 2});
+        if (node->left)
+            pending.push_back({node->left.get(), depth + 2});
+    }
+}
+
 // Converts node types to their string representation
 string nodeTypeToString(NodeType type)
 {
@@ -82,6 +200,12 @@ string nodeTypeToString(NodeType type)
         return "StringLiteral";
     case NodeType::FunctionCall:
         return "FunctionCall";
+    case NodeType::Import:
+        return "Import";
+    case NodeType::Label:
+        return "Label";
+    case NodeType::Goto:
+        return "Goto";
     default:
         return "Unknown";
     }
@@ -1,14 +1,88 @@
 #include "codegen.h"
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
 
 using namespace std;
 
+// A pending piece of output. The generator walks the AST with an explicit
+// work stack, so deeply nested input never deepens the C++ call stack.
+struct CodeGenerator::Task
+{
+    enum Kind
+    {
+        Text,
+        Statement,
+        Expression,
+        Operand // expression whose parentheses the parent has already decided on
+    } kind;
+    shared_ptr<ASTNode> node;
+    string text;
+};
+
+// Collects the pieces of a single node in output order
+class CodeGenerator::Emitter
+{
+public:
+    void text(const string &s) { parts.push_back({Task::Text, nullptr, s}); }
+    void statement(const shared_ptr<ASTNode> &node) { parts.push_back({Task::Statement, node, ""}); }
+    void expression(const shared_ptr<ASTNode> &node) { parts.push_back({Task::Expression, node, ""}); }
+    void operand(const shared_ptr<ASTNode> &node) { parts.push_back({Task::Operand, node, ""}); }
+
+    // Push onto the work stack so the first piece is processed first
+    void scheduleOn(vector<Task> &work)
+    {
+        for (auto it = parts.rbegin(); it != parts.rend(); ++it)
+            work.push_back(move(*it));
+        parts.clear();
+    }
+
+private:
+    vector<Task> parts;
+};
+
 // Code generator class for translating AST to C code
 CodeGenerator::CodeGenerator() {}
 
+// Maps a BasicCode type to the C type used for it
+static const char *cTypeName(VarType type, const char *fallback)
+{
+    switch (type)
+    {
+    case VarType::Float:
+        return "float";
+    case VarType::Int:
+    case VarType::Bool:
+        return "int";
+    case VarType::String:
+        return "const char*";
+    default:
+        return fallback;
+    }
+}
+
+// Writes a C prototype for a function signature
+static void writePrototype(const FunctionSignature &sig, ostream &out)
+{
+    out << cTypeName(sig.returnType, "void") << " " << sig.name << "(";
+    for (size_t i = 0; i < sig.paramTypes.size(); ++i)
+    {
+        if (i > 0)
+            out << ", ";
+        out << cTypeName(sig.paramTypes[i], "int") << " " << sig.paramNames[i];
+    }
+    out << ");\n";
+}
+
+// Imported functions are linked from the module's object file, so only their prototypes are emitted
+void CodeGenerator::declareExtern(const FunctionSignature &signature)
+{
+    externs.push_back(signature);
+}
+
 // Main generation function - creates C file with necessary includes
 void CodeGenerator::generate(const shared_ptr<ASTNode> &root, const string &outputFile)
 {
@@ -20,31 +94,166 @@ void CodeGenerator::generate(const shared_ptr<ASTNode> &root, const string &outp
     }
 
     out << "#include <stdio.h>\n\n";
+    if (profiling)
+        writeProfilerRuntime(out, profileReport, profileFolded);
+
+    for (const auto &sig : externs)
+        writePrototype(sig, out);
+    if (!externs.empty())
+        out << "\n";
+
     generateNode(root, out);
+    if (profiling)
+        writeProfilerSites(out, profileSites);
     out.close();
 }
 
+void CodeGenerator::enableProfiling(const string &reportFile, const string &foldedFile)
+{
+    profiling = true;
+    profileReport = reportFile;
+    profileFolded = foldedFile;
+}
+
+bool CodeGenerator::begin(const string &outputFile, const string &declsFile)
+{
+    stream.open(outputFile);
+    decls.open(declsFile);
+    if (!stream.is_open() || !decls.is_open())
+    {
+        cerr << "Failed to open output file: " << outputFile << '\n';
+        return false;
+    }
+
+    stream << "#include <stdio.h>\n";
+    stream << "#include \"" << filesystem::path(declsFile).filename().string() << "\"\n\n";
+    if (profiling)
+        writeProfilerRuntime(stream, profileReport, profileFolded);
+    return true;
+}
+
+// Generates one top-level statement; its subtree can be freed afterwards
+void CodeGenerator::emitTopLevel(const shared_ptr<ASTNode> &node)
+{
+    if (!node)
+        return;
+
+    if (node->type == NodeType::Function)
+        writePrototype(signatureOf(node), decls);
+    generateNode(node, stream);
+}
+
+void CodeGenerator::finish()
+{
+    for (const auto &sig : externs)
+        writePrototype(sig, decls);
+    decls.close();
+    if (profiling)
+        writeProfilerSites(stream, profileSites);
+    stream.close();
+}
+
 // Handles program and block nodes by generating their child statements
 void CodeGenerator::generateNode(const shared_ptr<ASTNode> &node, ostream &out)
 {
     if (!node)
         return;
 
+    Emitter emit;
     if (node->type == NodeType::Program || node->type == NodeType::Block)
     {
         for (const auto &child : node->children)
         {
-            generateStatement(child, out);
+            emit.statement(child);
         }
     }
     else
     {
-        generateStatement(node, out);
+        emit.statement(node);
+    }
+
+    vector<Task> work;
+    emit.scheduleOn(work);
+    while (!work.empty())
+    {
+        Task task = move(work.back());
+        work.pop_back();
+
+        switch (task.kind)
+        {
+        case Task::Text:
+            out << task.text;
+            break;
+        case Task::Statement:
+            expandStatement(task.node, emit);
+            break;
+        case Task::Expression:
+            expandExpression(task.node, false, emit);
+            break;
+        case Task::Operand:
+            expandExpression(task.node, true, emit);
+            break;
+        }
+        emit.scheduleOn(work);
+    }
+}
+
+// Binding strength of C binary operators, used to drop redundant parentheses
+static int precedence(const string &op)
+{
+    if (op == "*" || op == "/" || op == "%")
+        return 5;
+    if (op == "+" || op == "-")
+        return 4;
+    if (op == "<" || op == ">" || op == "<=" || op == ">=")
+        return 3;
+    if (op == "==" || op == "!=")
+        return 2;
+    if (op == "&&")
+        return 1;
+    if (op == "||")
+        return 0;
+    return -1;
+}
+
+// True if a child of a binary operation can be emitted without its own parentheses.
+// Keeping long left-associative chains flat also keeps the C compiler's nesting shallow.
+static bool canOmitParens(const shared_ptr<ASTNode> &parent, const shared_ptr<ASTNode> &child, bool isLeft)
+{
+    if (!child || child->type != NodeType::BinaryOp)
+        return false;
+
+    int outer = precedence(parent->strVal);
+    int inner = precedence(child->strVal);
+    if (outer < 0 || inner < 0)
+        return false;
+    return inner > outer || (isLeft && inner == outer);
+}
+
+// Registers a loop as a profile site and starts its timer before the loop
+int CodeGenerator::addProfileSite(const string &kind, const shared_ptr<ASTNode> &loop, Emitter &emit)
+{
+    int site = static_cast<int>(profileSites.size());
+    profileSites.push_back({kind + "@" + to_string(loop->line), "loop", loop->line});
+    emit.text("bac_prof_enter(" + to_string(site) + ");\n");
+    return site;
+}
+
+// Emits a loop body, counting iterations and stopping the loop's timer afterwards
+void CodeGenerator::profileLoopBody(int site, const shared_ptr<ASTNode> &body, Emitter &emit)
+{
+    if (site < 0)
+    {
+        emit.statement(body);
+        return;
     }
+    emit.text("{\nbac_prof_sites[" + to_string(site) + "].iterations++;\n");
+    emit.statement(body);
+    emit.text("}\nbac_prof_leave(" + to_string(site) + ");\n");
 }
 
 // Generates C code for different types of statements (if, while, for, etc.)
-void CodeGenerator::generateStatement(const shared_ptr<ASTNode> &node, ostream &out)
+void CodeGenerator::expandStatement(const shared_ptr<ASTNode> &node, Emitter &emit)
 {
     if (!node)
         return;
@@ -56,147 +265,156 @@ void CodeGenerator::generateStatement(const shared_ptr<ASTNode> &node, ostream &
     case NodeType::Declaration:
         if (node->children[0]->type == NodeType::FloatLiteral)
         {
-            out << "float ";
+            emit.text("float ");
         }
         else
         {
-            out << "int ";
+            emit.text("int ");
         }
-        out << node->strVal << " = ";
-        generateExpression(node->children[0], out);
-        out << ";\n";
+        emit.text(node->strVal + " = ");
+        emit.expression(node->children[0]);
+        emit.text(";\n");
         break;
 
     // Variable assignments
     case NodeType::Assignment:
-        out << node->strVal << " = ";
-        generateExpression(node->children[0], out);
-        out << ";\n";
+        emit.text(node->strVal + " = ");
+        emit.expression(node->children[0]);
+        emit.text(";\n");
         break;
 
     // Return statements with optional value
     case NodeType::Return:
-        out << "return ";
+        // When profiling, the value is computed before the function's timer stops
+        if (profiling && functionSite >= 0 && !node->children.empty())
+        {
+            emit.text("{ " + functionReturnType + " bac_prof_ret = ");
+            emit.expression(node->children[0]);
+            emit.text("; bac_prof_leave(" + to_string(functionSite) + "); return bac_prof_ret; }\n");
+            break;
+        }
+        if (profiling && functionSite >= 0)
+            emit.text("bac_prof_leave(" + to_string(functionSite) + ");\n");
+        emit.text("return ");
         if (!node->children.empty())
         {
-            generateExpression(node->children[0], out);
+            emit.expression(node->children[0]);
         }
-        out << ";\n";
+        emit.text(";\n");
         break;
 
     // Control flow statements
     case NodeType::If:
-        out << "if (";
-        generateExpression(node->children[0], out);
-        out << ") ";
-        generateStatement(node->children[1], out);
+        emit.text("if (");
+        emit.expression(node->children[0]);
+        emit.text(") ");
+        emit.statement(node->children[1]);
         break;
 
     case NodeType::IfElse:
-        out << "if (";
-        generateExpression(node->children[0], out);
-        out << ") ";
-        generateStatement(node->children[1], out);
-        out << " else ";
-        generateStatement(node->children[2], out);
+        emit.text("if (");
+        emit.expression(node->children[0]);
+        emit.text(") ");
+        emit.statement(node->children[1]);
+        emit.text(" else ");
+        emit.statement(node->children[2]);
         break;
 
     case NodeType::While:
-        out << "while (";
-        generateExpression(node->children[0], out);
-        out << ") ";
-        generateStatement(node->children[1], out);
+    {
+        int site = profiling ? addProfileSite("while", node, emit) : -1;
+        emit.text("while (");
+        emit.expression(node->children[0]);
+        emit.text(") ");
+        profileLoopBody(site, node->children[1], emit);
         break;
+    }
 
     case NodeType::For:
-        out << "for (";
+    {
+        int site = profiling ? addProfileSite("for", node, emit) : -1;
+        emit.text("for (");
         if (node->children[0]->type == NodeType::Declaration)
         {
-            out << "int " << node->children[0]->strVal << " = ";
-            generateExpression(node->children[0]->children[0], out);
+            emit.text("int " + node->children[0]->strVal + " = ");
+            emit.expression(node->children[0]->children[0]);
         }
         else
         {
-            out << node->children[0]->strVal << " = ";
-            generateExpression(node->children[0]->children[0], out);
+            emit.text(node->children[0]->strVal + " = ");
+            emit.expression(node->children[0]->children[0]);
         }
-        out << "; ";
-        generateExpression(node->children[1], out);
-        out << "; ";
-        generateExpression(node->children[2], out);
-        out << ") ";
-        generateStatement(node->children[3], out);
+        emit.text("; ");
+        emit.expression(node->children[1]);
+        emit.text("; ");
+        emit.expression(node->children[2]);
+        emit.text(") ");
+        profileLoopBody(site, node->children[3], emit);
         break;
+    }
 
     // Function definitions with type handling
     case NodeType::Function:
     {
-        switch (node->valueType)
-        {
-        case VarType::Float:
-            out << "float ";
-            break;
-        case VarType::Int:
-            out << "int ";
-            break;
-        case VarType::Bool:
-            out << "int ";
-            break;
-        case VarType::String:
-            out << "const char* ";
-            break;
-        default:
-            out << "void ";
-            break;
-        }
-
-        out << node->strVal << "(";
+        emit.text(string(cTypeName(node->valueType, "void")) + " " + node->strVal + "(");
         firstParam = true;
         for (const auto &child : node->children)
         {
             if (child->type == NodeType::Argument)
             {
                 if (!firstParam)
-                    out << ", ";
+                    emit.text(", ");
                 firstParam = false;
-
-                switch (child->valueType)
-                {
-                case VarType::Float:
-                    out << "float ";
-                    break;
-                case VarType::Int:
-                    out << "int ";
-                    break;
-                case VarType::Bool:
-                    out << "int ";
-                    break;
-                case VarType::String:
-                    out << "const char* ";
-                    break;
-                default:
-                    out << "int ";
-                    break;
-                }
-                out << child->strVal;
+                emit.text(string(cTypeName(child->valueType, "int")) + " " + child->strVal);
             }
         }
-        out << ") ";
+        emit.text(") ");
+
+        if (profiling)
+        {
+            // Returns inside the body are generated before the next function starts
+            functionSite = static_cast<int>(profileSites.size());
+            functionReturnType = cTypeName(node->valueType, "int");
+            profileSites.push_back({node->strVal, "function", node->line});
+
+            emit.text("{\n");
+            if (node->strVal == "main")
+                emit.text("atexit(bac_prof_report);\n");
+            emit.text("bac_prof_enter(" + to_string(functionSite) + ");\n");
+        }
 
         for (const auto &child : node->children)
         {
             if (child->type == NodeType::Block)
-                generateStatement(child, out);
+                emit.statement(child);
         }
+
+        if (profiling)
+            emit.text("bac_prof_leave(" + to_string(functionSite) + ");\n}\n");
         break;
     }
 
+    // Jump targets introduced by the optimizer (tail call elimination)
+    case NodeType::Label:
+        emit.text(node->strVal + ":;\n");
+        break;
+
+    case NodeType::Goto:
+        if (profiling && functionSite >= 0)
+            emit.text("bac_prof_unwind(" + to_string(functionSite) + ");\n");
+        emit.text("goto " + node->strVal + ";\n");
+        break;
+
+    // Imports are resolved by the module loader before code generation
+    case NodeType::Import:
+        break;
+
     // Code blocks with proper bracing
     case NodeType::Block:
-        out << "{\n";
+        emit.text("{\n");
         for (const auto &stmt : node->children)
-            generateStatement(stmt, out);
-        out << "}\n";
+            emit.statement(stmt);
+        emit.text("}\n");
         break;
 
     // Function calls with special handling for print function
@@ -208,120 +426,132 @@ void CodeGenerator::generateStatement(const shared_ptr<ASTNode> &node, ostream &
             switch (arg->type)
             {
             case NodeType::StringLiteral:
-                out << "printf(\"%s\", ";
+                emit.text("printf(\"%s\", ");
                 break;
             case NodeType::FloatLiteral:
             case NodeType::Identifier:
                 if (arg->valueType == VarType::Float)
                 {
-                    out << "printf(\"%f\", ";
+                    emit.text("printf(\"%f\", ");
                 }
                 else
                 {
-                    out << "printf(\"%d\", ";
+                    emit.text("printf(\"%d\", ");
                 }
                 break;
             case NodeType::BoolLiteral:
-                out << "printf(\"%s\", ";
+                emit.text("printf(\"%s\", ");
                 break;
             default:
-                out << "printf(\"%d\", ";
+                emit.text("printf(\"%d\", ");
                 break;
             }
-            generateExpression(arg, out);
-            out << ");\n";
+            emit.expression(arg);
+            emit.text(");\n");
         }
         else
         {
-            out << node->strVal << "(";
+            emit.text(node->strVal + "(");
             for (size_t i = 0; i < node->children.size(); ++i)
             {
-                generateExpression(node->children[i], out);
+                emit.expression(node->children[i]);
                 if (i + 1 < node->children.size())
-                    out << ", ";
+                    emit.text(", ");
             }
-            out << ")";
+            emit.text(")");
         }
         break;
 
     default:
-        out << "\n";
+        emit.text("\n");
         break;
     }
 }
 
-// Generates C code for expressions (literals, operations, function calls)
-void CodeGenerator::generateExpression(const shared_ptr<ASTNode> &node, ostream &out)
+// Generates C code for expressions (literals, operations, function calls).
+// `bare` is set when the parent operation has determined no parentheses are needed.
+void CodeGenerator::expandExpression(const shared_ptr<ASTNode> &node, bool bare, Emitter &emit)
 {
     if (!node)
         return;
 
+    ostringstream literal;
+
     switch (node->type)
     {
     // Basic expressions
     case NodeType::Assignment:
-        out << node->strVal << " = ";
-        generateExpression(node->children[0], out);
+        emit.text(node->strVal + " = ");
+        emit.expression(node->children[0]);
         break;
 
     // Literal values
     case NodeType::IntLiteral:
-        out << node->intVal;
+        emit.text(to_string(node->intVal));
         break;
 
     case NodeType::FloatLiteral:
-        out << node->floatVal;
+        literal << node->floatVal;
+        emit.text(literal.str());
         break;
 
     case NodeType::BoolLiteral:
-        out << (node->strVal == "true" ? "1" : "0");
+        emit.text(node->strVal == "true" ? "1" : "0");
         break;
 
     case NodeType::StringLiteral:
-        out << "\"" << node->strVal << "\"";
+        emit.text("\"" + node->strVal + "\"");
         break;
 
     // Variable references
     case NodeType::Identifier:
-        out << node->strVal;
+        emit.text(node->strVal);
         break;
 
     // Binary operations with parentheses for precedence
     case NodeType::BinaryOp:
-        out << "(";
-        generateExpression(node->left, out);
-        out << " " << node->strVal << " ";
-        generateExpression(node->right, out);
-        out << ")";
+        if (!bare)
+            emit.text("(");
+        if (canOmitParens(node, node->left, true))
+            emit.operand(node->left);
+        else
+            emit.expression(node->left);
+        emit.text(" " + node->strVal + " ");
+        if (canOmitParens(node, node->right, false))
+            emit.operand(node->right);
+        else
+            emit.expression(node->right);
+        if (!bare)
+            emit.text(")");
         break;
 
     // Unary operations
     case NodeType::UnaryOp:
-        out << node->strVal;
-        generateExpression(node->children[0], out);
+        emit.text(node->strVal);
+        emit.expression(node->children[0]);
         break;
 
     // Function calls in expressions
     case NodeType::FunctionCall:
         if (node->strVal == "print")
         {
-            out << "/* print() used as expression — invalid */";
+            emit.text("/* print() used as expression — invalid */");
         }
         else
         {
-            out << node->strVal << "(";
+            emit.text(node->strVal + "(");
             for (size_t i = 0; i < node->children.size(); ++i)
             {
-                generateExpression(node->children[i], out);
+                emit.expression(node->children[i]);
                 if (i + 1 < node->children.size())
-                    out << ", ";
+                    emit.text(", ");
             }
-            out << ")\n";
+            emit.text(")\n");
         }
         break;
 
     default:
-        out << "/* unknown expr */";
+        emit.text("/* unknown expr */");
         break;
     }
 }
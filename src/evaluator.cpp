@@ -0,0 +1,406 @@
+// Compile-time evaluation of pure functions
+#include "evaluator.h"
+#include <climits>
+#include <cstdint>
+
+using namespace std;
+
+// Interpreter recursion is bounded so folding can't overflow the compiler's own stack
+static const int MAX_EVAL_DEPTH = 512;
+
+ConstEvaluator::ConstEvaluator(long stepBudget) : stepBudget(stepBudget) {}
+
+// Registers every top-level function definition by name
+void ConstEvaluator::addFunctions(const shared_ptr<ASTNode> &program)
+{
+    if (!program)
+        return;
+
+    for (const auto &child : program->children)
+    {
+        if (child && child->type == NodeType::Function)
+            functions[child->strVal] = child;
+    }
+}
+
+// Local check of one function: no print, no names other than its parameters and
+// `let` locals, no constructs the interpreter can't reproduce. Callees are returned
+// so purity can be propagated afterwards.
+static bool isLocallyPure(const shared_ptr<ASTNode> &function, unordered_set<string> &callees)
+{
+    unordered_set<string> locals;
+    vector<const ASTNode *> pending;
+    for (const auto &child : function->children)
+    {
+        if (child->type == NodeType::Argument)
+            locals.insert(child->strVal);
+        else
+            pending.push_back(child.get());
+    }
+
+    // First collect locals, since a use may appear before the walk reaches its `let`
+    vector<const ASTNode *> nodes;
+    while (!pending.empty())
+    {
+        const ASTNode *node = pending.back();
+        pending.pop_back();
+        if (!node)
+            continue;
+        nodes.push_back(node);
+        if (node->type == NodeType::Declaration)
+            locals.insert(node->strVal);
+        pending.push_back(node->left.get());
+        pending.push_back(node->right.get());
+        for (const auto &child : node->children)
+            pending.push_back(child.get());
+    }
+
+    for (const ASTNode *node : nodes)
+    {
+        switch (node->type)
+        {
+        case NodeType::FunctionCall:
+            if (node->strVal == "print")
+                return false;
+            callees.insert(node->strVal);
+            break;
+        case NodeType::Identifier:
+        case NodeType::Assignment:
+            if (!locals.count(node->strVal))
+                return false; // reads or writes a global
+            break;
+        case NodeType::Function:
+        case NodeType::Import:
+        case NodeType::Label:
+        case NodeType::Goto:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+// Purity propagates through calls: start from the locally pure functions and
+// drop any that call something impure until nothing changes
+void ConstEvaluator::analyzePurity()
+{
+    unordered_map<string, unordered_set<string>> calls;
+    pure.clear();
+    for (const auto &[name, function] : functions)
+    {
+        unordered_set<string> callees;
+        if (isLocallyPure(function, callees))
+        {
+            pure.insert(name);
+            calls[name] = callees;
+        }
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto it = pure.begin(); it != pure.end();)
+        {
+            bool callsImpure = false;
+            for (const auto &callee : calls[*it])
+            {
+                if (!pure.count(callee))
+                    callsImpure = true;
+            }
+
+            if (callsImpure)
+            {
+                it = pure.erase(it);
+                changed = true;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+}
+
+bool ConstEvaluator::isPure(const string &name) const
+{
+    return pure.count(name) > 0;
+}
+
+bool ConstEvaluator::evaluate(const string &name, const vector<int> &args, int &result, long &usedSteps)
+{
+    steps = 0;
+    depth = 0;
+    bool ok = isPure(name) && call(name, args, result);
+    usedSteps = steps;
+    return ok;
+}
+
+// Counts one unit of work; false once the budget is exhausted
+bool ConstEvaluator::tick()
+{
+    return ++steps <= stepBudget;
+}
+
+bool ConstEvaluator::call(const string &name, const vector<int> &args, int &result)
+{
+    auto it = functions.find(name);
+    if (it == functions.end() || !isPure(name) || depth >= MAX_EVAL_DEPTH)
+        return false;
+
+    Frame frame;
+    frame.scopes.emplace_back();
+
+    shared_ptr<ASTNode> body;
+    size_t param = 0;
+    for (const auto &child : it->second->children)
+    {
+        if (child->type == NodeType::Argument)
+        {
+            if (param >= args.size())
+                return false;
+            frame.scopes.back()[child->strVal] = args[param++];
+        }
+        else if (child->type == NodeType::Block)
+        {
+            body = child;
+        }
+    }
+    if (param != args.size() || !body)
+        return false;
+
+    ++depth;
+    Flow flow = execute(body, frame);
+    --depth;
+
+    // Falling off the end of a non-void function has no defined value in C
+    if (flow != Flow::Returned)
+        return false;
+    result = frame.returnValue;
+    return true;
+}
+
+ConstEvaluator::Flow ConstEvaluator::execute(const shared_ptr<ASTNode> &node, Frame &frame)
+{
+    if (!node || !tick() || depth >= MAX_EVAL_DEPTH)
+        return Flow::Failed;
+
+    ++depth;
+    Flow flow = Flow::Normal;
+    int value = 0;
+
+    switch (node->type)
+    {
+    case NodeType::Block:
+        frame.scopes.emplace_back();
+        for (const auto &stmt : node->children)
+        {
+            flow = execute(stmt, frame);
+            if (flow != Flow::Normal)
+                break;
+        }
+        frame.scopes.pop_back();
+        break;
+
+    case NodeType::Declaration:
+        if (!eval(node->children[0], frame, value))
+            flow = Flow::Failed;
+        else
+            frame.scopes.back()[node->strVal] = value;
+        break;
+
+    case NodeType::Assignment:
+        if (!eval(node, frame, value))
+            flow = Flow::Failed;
+        break;
+
+    case NodeType::Return:
+        if (node->children.empty() || !eval(node->children[0], frame, frame.returnValue))
+            flow = Flow::Failed;
+        else
+            flow = Flow::Returned;
+        break;
+
+    case NodeType::If:
+    case NodeType::IfElse:
+        if (!eval(node->children[0], frame, value))
+            flow = Flow::Failed;
+        else if (value)
+            flow = execute(node->children[1], frame);
+        else if (node->type == NodeType::IfElse)
+            flow = execute(node->children[2], frame);
+        break;
+
+    case NodeType::While:
+        while (flow == Flow::Normal)
+        {
+            if (!eval(node->children[0], frame, value))
+                flow = Flow::Failed;
+            else if (!value)
+                break;
+            else
+                flow = execute(node->children[1], frame);
+        }
+        break;
+
+    case NodeType::For:
+        if (!eval(node->children[0], frame, value))
+            flow = Flow::Failed;
+        while (flow == Flow::Normal)
+        {
+            if (!eval(node->children[1], frame, value))
+                flow = Flow::Failed;
+            else if (!value)
+                break;
+            else if ((flow = execute(node->children[3], frame)) == Flow::Normal && !eval(node->children[2], frame, value))
+                flow = Flow::Failed;
+        }
+        break;
+
+    // Expression statements, e.g. a call whose result is discarded
+    case NodeType::FunctionCall:
+    case NodeType::BinaryOp:
+    case NodeType::Identifier:
+    case NodeType::IntLiteral:
+        if (!eval(node, frame, value))
+            flow = Flow::Failed;
+        break;
+
+    default:
+        flow = Flow::Failed;
+        break;
+    }
+
+    --depth;
+    return flow;
+}
+
+// Applies a binary operator with C int semantics; false on overflow or division by zero
+static bool applyBinary(const string &op, int lhs, int rhs, int &value)
+{
+    int64_t a = lhs, b = rhs, r;
+
+    if (op == "+")
+        r = a + b;
+    else if (op == "-")
+        r = a - b;
+    else if (op == "*")
+        r = a * b;
+    else if (op == "/" || op == "%")
+    {
+        if (b == 0 || (a == INT_MIN && b == -1))
+            return false;
+        r = (op == "/") ? a / b : a % b;
+    }
+    else if (op == "<")
+        r = a < b;
+    else if (op == ">")
+        r = a > b;
+    else if (op == "<=")
+        r = a <= b;
+    else if (op == ">=")
+        r = a >= b;
+    else if (op == "==")
+        r = a == b;
+    else if (op == "!=")
+        r = a != b;
+    else
+        return false;
+
+    if (r < INT_MIN || r > INT_MAX)
+        return false;
+    value = static_cast<int>(r);
+    return true;
+}
+
+bool ConstEvaluator::eval(const shared_ptr<ASTNode> &node, Frame &frame, int &value)
+{
+    if (!node || !tick() || depth >= MAX_EVAL_DEPTH)
+        return false;
+
+    ++depth;
+    bool ok = true;
+
+    switch (node->type)
+    {
+    case NodeType::IntLiteral:
+        value = node->intVal;
+        break;
+
+    case NodeType::Identifier:
+    {
+        ok = false;
+        for (auto it = frame.scopes.rbegin(); it != frame.scopes.rend(); ++it)
+        {
+            auto found = it->find(node->strVal);
+            if (found != it->end())
+            {
+                value = found->second;
+                ok = true;
+                break;
+            }
+        }
+        break;
+    }
+
+    case NodeType::Assignment:
+    {
+        ok = eval(node->children[0], frame, value);
+        if (!ok)
+            break;
+
+        ok = false;
+        for (auto it = frame.scopes.rbegin(); it != frame.scopes.rend(); ++it)
+        {
+            auto found = it->find(node->strVal);
+            if (found != it->end())
+            {
+                found->second = value;
+                ok = true;
+                break;
+            }
+        }
+        break;
+    }
+
+    case NodeType::BinaryOp:
+    {
+        int lhs = 0, rhs = 0;
+        if (node->strVal == "&&" || node->strVal == "||")
+        {
+            ok = eval(node->left, frame, lhs);
+            if (ok && ((node->strVal == "&&") == (lhs != 0)))
+                ok = eval(node->right, frame, rhs);
+            value = (node->strVal == "&&") ? (lhs && rhs) : (lhs || rhs);
+            break;
+        }
+        ok = eval(node->left, frame, lhs) && eval(node->right, frame, rhs) &&
+             applyBinary(node->strVal, lhs, rhs, value);
+        break;
+    }
+
+    case NodeType::FunctionCall:
+    {
+        vector<int> args;
+        for (const auto &arg : node->children)
+        {
+            int argValue = 0;
+            ok = eval(arg, frame, argValue);
+            if (!ok)
+                break;
+            args.push_back(argValue);
+        }
+        ok = ok && call(node->strVal, args, value);
+        break;
+    }
+
+    // Floats, strings and booleans aren't reproduced exactly, so those calls stay at runtime
+    default:
+        ok = false;
+        break;
+    }
+
+    --depth;
+    return ok;
+}
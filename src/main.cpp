@@ -1,28 +1,71 @@
 #include "lexer.h"
 #include "parser.h"
 #include "codegen.h"
+#include "module.h"
+#include "optimizer.h"
 #include "ast.h"
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <filesystem>
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 using namespace std;
 
 extern int yyparse();
 extern FILE *yyin;
 extern shared_ptr<ASTNode> root;
 
+// Peak resident memory of this process in KB, or -1 where it can't be queried
+static long peakMemoryKB()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // reported in bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
 int main(int argc, char *argv[])
 {
-    if (argc < 2)
+    // Parse command line options
+    const char *inputFile = nullptr;
+    bool streaming = false;
+    bool profiling = false;
+    bool dumpingTokens = false;
+    bool benchmarking = false;
+    for (int i = 1; i < argc; ++i)
     {
-        cerr << "Usage: " << argv[0] << " <source.bac>\n";
+        string arg = argv[i];
+        if (arg == "--stream")
+            streaming = true;
+        else if (arg == "--profile")
+            profiling = true;
+        else if (arg == "--tokens")
+            dumpingTokens = true;
+        else if (arg == "--lex-bench")
+            benchmarking = true;
+        else if (!inputFile)
+            inputFile = argv[i];
+    }
+
+    if (!inputFile)
+    {
+        cerr << "Usage: " << argv[0] << " [--stream] [--profile] [--tokens] [--lex-bench] <source.bac>\n";
         return EXIT_FAILURE;
     }
 
     // Setup input and output paths
-    const char *inputFile = argv[1];
     filesystem::path inputPath(inputFile);
     string baseFilename = inputPath.stem().string();
 
@@ -41,32 +84,133 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    // Lexer-only modes: print the token stream, or measure lexing speed
+    if (dumpingTokens)
+    {
+        dumpTokens(cout);
+        fclose(yyin);
+        return EXIT_SUCCESS;
+    }
+    if (benchmarking)
+    {
+        fclose(yyin);
+        yyin = nullptr;
+        return benchmarkLexer(inputFile) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Setup output directory structure
+    filesystem::path exePath = filesystem::path(argv[0]);
+    filesystem::path projectDir = exePath.parent_path().parent_path();
+    filesystem::path outputDir = projectDir / "output";
+    filesystem::create_directory(outputDir);
+
+    // Define output files
+    string outputFile = (outputDir / (baseFilename + ".c")).string();
+    string outputExe = (outputDir / (baseFilename + ".exe")).string();
+
+    CodeGenerator codegen;
+    Optimizer optimizer;
+
+    // The instrumented program writes its profile next to the generated code
+    string profileReport = filesystem::absolute(outputDir / (baseFilename + ".profile.txt")).string();
+    string profileFolded = filesystem::absolute(outputDir / (baseFilename + ".folded")).string();
+    if (profiling)
+        codegen.enableProfiling(profileReport, profileFolded);
+
+    // In streaming mode each top-level statement is optimized, emitted and freed
+    // as soon as it is parsed, so memory doesn't grow with the size of the input.
+    // Imports are kept and resolved once parsing is done.
+    if (streaming)
+    {
+        string declsFile = (outputDir / (baseFilename + ".decls.h")).string();
+        if (!codegen.begin(outputFile, declsFile))
+        {
+            fclose(yyin);
+            return EXIT_FAILURE;
+        }
+
+        onTopLevelStatement = [&](const shared_ptr<ASTNode> &node)
+        {
+            if (node && node->type == NodeType::Import)
+                return false;
+            optimizer.optimizeStatement(node);
+            codegen.emitTopLevel(node);
+            return true;
+        };
+        cout << "🌊 Streaming code generation to `" << outputFile << "`\n";
+    }
+
     cout << "🔍 Parsing " << inputFile << "...\n";
 
     // Parse input and generate code if successful
     if (yyparse() == 0 && root)
     {
-        // Setup output directory structure
-        filesystem::path exePath = filesystem::path(argv[0]);
-        filesystem::path projectDir = exePath.parent_path().parent_path();
-        filesystem::path outputDir = projectDir / "output";
-        filesystem::create_directory(outputDir);
-
-        // Define output files
-        string outputFile = (outputDir / (baseFilename + ".c")).string();
-        string outputExe = (outputDir / (baseFilename + ".exe")).string();
-
-        // Generate C code
-        cout << "\n🚧 --- Generating Code ---\n";
-        CodeGenerator codegen;
-        codegen.generate(root, outputFile);
-        cout << "✅ Output written to `" << outputFile << "`\n";
+        onTopLevelStatement = nullptr;
+
+        // Resolve imports to precompiled modules
+        ModuleLoader loader(outputDir.string());
+        if (!loader.loadImports(root, inputFile))
+        {
+            cerr << "❌ Failed to load imported modules.\n";
+            fclose(yyin);
+            return EXIT_FAILURE;
+        }
+
+        for (const auto &module : loader.modules())
+            for (const auto &sig : module.exports)
+                codegen.declareExtern(sig);
+
+        // Cached module objects aren't instrumented, so a profiled program gets
+        // its own instrumented copy of every imported function instead
+        vector<shared_ptr<ASTNode>> profiledModules;
+        if (profiling)
+            for (const auto &module : loader.modules())
+                profiledModules.push_back(loader.optimizedAst(module));
+
+        if (streaming)
+        {
+            for (const auto &module : profiledModules)
+                for (const auto &statement : module->children)
+                    codegen.emitTopLevel(statement);
+            codegen.finish();
+            cout << "✅ Output written to `" << outputFile << "`\n";
+
+            long peakKB = peakMemoryKB();
+            if (peakKB >= 0)
+            {
+                cout << "📈 Peak memory: " << peakKB << " KB for "
+                     << filesystem::file_size(inputPath) / 1024 << " KB of source\n";
+            }
+        }
+        else
+        {
+            for (const auto &module : loader.modules())
+                optimizer.addLibrary(module.ast);
+            optimizer.optimize(root);
+            for (const auto &module : profiledModules)
+                root->children.insert(root->children.end(), module->children.begin(), module->children.end());
+
+            // Generate C code
+            cout << "\n🚧 --- Generating Code ---\n";
+            codegen.generate(root, outputFile);
+            cout << "✅ Output written to `" << outputFile << "`\n";
+        }
 
         // Compile and run the generated code
         cout << "\n🚧 --- Compiling and Running ---\n";
-        string compileCmd = "gcc \"" + outputFile + "\" -o \"" + outputExe + "\"";
+        string compileCmd = "gcc \"" + outputFile + "\"";
+        if (!profiling)
+            for (const auto &module : loader.modules())
+                compileCmd += " \"" + module.objectPath + "\"";
+        compileCmd += " -o \"" + outputExe + "\"";
         string runCmd = "\"" + outputExe + "\"";
         system((compileCmd + " && " + runCmd).c_str());
+
+        if (profiling)
+        {
+            cout << "\n📊 Profile written to `" << profileReport << "`\n";
+            cout << "🔥 Folded stacks (for flamegraph.pl) written to `" << profileFolded << "`\n";
+        }
     }
     else
     {
@@ -0,0 +1,675 @@
+// Precompiled module (`.bacm`) support for `import` statements
+#include "module.h"
+#include "codegen.h"
+#include "optimizer.h"
+#include "parser.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+extern FILE *yyin;
+extern int yylineno;
+
+// Bumped whenever the on-disk layout changes, so stale modules get rebuilt
+static const char MODULE_MAGIC[4] = {'B', 'A', 'C', 'M'};
+static const uint32_t MODULE_VERSION = 4;
+
+// ---------------------------------------------------------------------------
+// Hashing
+// ---------------------------------------------------------------------------
+
+static const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+
+// FNV-1a; cheap and good enough to detect edits
+static uint64_t fnv1a(uint64_t hash, const char *data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t hashFile(const string &path)
+{
+    ifstream in(path, ios::binary);
+    if (!in.is_open())
+        return 0;
+
+    uint64_t hash = FNV_OFFSET;
+    char buffer[4096];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+        hash = fnv1a(hash, buffer, static_cast<size_t>(in.gcount()));
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Serialization
+// ---------------------------------------------------------------------------
+
+// Appends little-endian encoded values to a byte buffer
+class ModuleWriter {
+public:
+    string bytes;
+
+    void u8(uint8_t v) { bytes.push_back(static_cast<char>(v)); }
+
+    void u32(uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i)
+            u8(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void u64(uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i)
+            u8(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void f32(float v)
+    {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        u32(bits);
+    }
+
+    void str(const string &s)
+    {
+        u32(static_cast<uint32_t>(s.size()));
+        bytes.append(s);
+    }
+
+    // Preorder: header, left, right, child count, children.
+    // Walks with an explicit stack so deep trees serialize without recursion.
+    void node(const shared_ptr<ASTNode> &tree)
+    {
+        // A null entry with `countOf` set marks where that node's child count goes
+        struct Item
+        {
+            const ASTNode *node;
+            const ASTNode *countOf;
+        };
+        vector<Item> pending = {{tree.get(), nullptr}};
+
+        while (!pending.empty())
+        {
+            Item item = pending.back();
+            pending.pop_back();
+
+            if (item.countOf)
+            {
+                u32(static_cast<uint32_t>(item.countOf->children.size()));
+                continue;
+            }
+
+            const ASTNode *n = item.node;
+            if (!n)
+            {
+                u8(0);
+                continue;
+            }
+            u8(1);
+            u8(static_cast<uint8_t>(n->type));
+            u8(static_cast<uint8_t>(n->valueType));
+            u32(static_cast<uint32_t>(n->line));
+            u32(static_cast<uint32_t>(n->intVal));
+            f32(n->floatVal);
+            u8(n->boolVal ? 1 : 0);
+            str(n->strVal);
+
+            for (auto it = n->children.rbegin(); it != n->children.rend(); ++it)
+                pending.push_back({it->get(), nullptr});
+            pending.push_back({nullptr, n});
+            pending.push_back({n->right.get(), nullptr});
+            pending.push_back({n->left.get(), nullptr});
+        }
+    }
+};
+
+// Reads values back from a (memory-mapped) buffer, failing on truncation
+class ModuleReader {
+public:
+    ModuleReader(const char *data, size_t size) : pos(data), end(data + size) {}
+
+    bool ok = true;
+
+    uint8_t u8()
+    {
+        if (!need(1))
+            return 0;
+        return static_cast<uint8_t>(*pos++);
+    }
+
+    uint32_t u32()
+    {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i)
+            v |= static_cast<uint32_t>(u8()) << (8 * i);
+        return v;
+    }
+
+    uint64_t u64()
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= static_cast<uint64_t>(u8()) << (8 * i);
+        return v;
+    }
+
+    float f32()
+    {
+        uint32_t bits = u32();
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    string str()
+    {
+        uint32_t len = u32();
+        if (!need(len))
+            return "";
+        string s(pos, len);
+        pos += len;
+        return s;
+    }
+
+    bool bytes(void *dst, size_t len)
+    {
+        if (!need(len))
+            return false;
+        memcpy(dst, pos, len);
+        pos += len;
+        return true;
+    }
+
+    // Inverse of ModuleWriter::node, again without recursion
+    shared_ptr<ASTNode> node()
+    {
+        // Which slot of a partially read node is filled next
+        enum Stage
+        {
+            Left,
+            Right,
+            Count,
+            Children
+        };
+        struct Frame
+        {
+            shared_ptr<ASTNode> node;
+            Stage stage;
+            uint32_t remaining;
+        };
+
+        auto tree = header();
+        if (!tree)
+            return nullptr;
+        vector<Frame> pending = {{tree, Left, 0}};
+
+        while (ok && !pending.empty())
+        {
+            Frame &frame = pending.back();
+            if (frame.stage == Count)
+            {
+                frame.remaining = u32();
+                frame.stage = Children;
+                continue;
+            }
+            if (frame.stage == Children && frame.remaining == 0)
+            {
+                pending.pop_back();
+                continue;
+            }
+
+            auto child = header();
+            if (frame.stage == Left)
+            {
+                frame.node->left = child;
+                frame.stage = Right;
+            }
+            else if (frame.stage == Right)
+            {
+                frame.node->right = child;
+                frame.stage = Count;
+            }
+            else
+            {
+                frame.node->children.push_back(child);
+                --frame.remaining;
+            }
+
+            if (child)
+                pending.push_back({child, Left, 0});
+        }
+        return ok ? tree : nullptr;
+    }
+
+private:
+    const char *pos;
+    const char *end;
+
+    // Reads one node's own fields; its subtrees follow in the stream
+    shared_ptr<ASTNode> header()
+    {
+        if (!ok || u8() == 0)
+            return nullptr;
+
+        auto n = make_shared<ASTNode>(static_cast<NodeType>(u8()));
+        n->valueType = static_cast<VarType>(u8());
+        n->line = static_cast<int>(u32());
+        n->intVal = static_cast<int>(u32());
+        n->floatVal = f32();
+        n->boolVal = u8() != 0;
+        n->strVal = str();
+        return n;
+    }
+
+    bool need(size_t len)
+    {
+        if (!ok || static_cast<size_t>(end - pos) < len)
+            ok = false;
+        return ok;
+    }
+};
+
+// Read-only view of a whole file, memory-mapped where the platform allows it
+class MappedFile {
+public:
+    explicit MappedFile(const string &path)
+    {
+#ifndef _WIN32
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                mapped = static_cast<const char *>(addr);
+                length = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+#else
+        ifstream in(path, ios::binary);
+        if (in.is_open())
+        {
+            fallback.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+            length = fallback.size();
+        }
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap(const_cast<char *>(mapped), length);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const
+    {
+#ifndef _WIN32
+        return mapped;
+#else
+        return fallback.data();
+#endif
+    }
+
+    size_t size() const { return length; }
+    bool valid() const { return length > 0; }
+
+private:
+    size_t length = 0;
+#ifndef _WIN32
+    const char *mapped = nullptr;
+#else
+    string fallback;
+#endif
+};
+
+// Layout: magic, version, source path and hash, dependency table, export table,
+// then the AST in preorder
+bool writeModuleFile(const string &path, const Module &module)
+{
+    ModuleWriter w;
+    w.bytes.append(MODULE_MAGIC, sizeof(MODULE_MAGIC));
+    w.u32(MODULE_VERSION);
+    w.str(module.sourcePath);
+    w.u64(module.sourceHash);
+
+    w.u32(static_cast<uint32_t>(module.dependencies.size()));
+    for (const auto &dep : module.dependencies)
+    {
+        w.str(dep.sourcePath);
+        w.u64(dep.sourceHash);
+    }
+
+    w.u32(static_cast<uint32_t>(module.exports.size()));
+    for (const auto &sig : module.exports)
+    {
+        w.str(sig.name);
+        w.u8(static_cast<uint8_t>(sig.returnType));
+        w.u32(static_cast<uint32_t>(sig.paramTypes.size()));
+        for (size_t i = 0; i < sig.paramTypes.size(); ++i)
+        {
+            w.u8(static_cast<uint8_t>(sig.paramTypes[i]));
+            w.str(sig.paramNames[i]);
+        }
+    }
+
+    w.node(module.ast);
+
+    ofstream out(path, ios::binary);
+    if (!out.is_open())
+        return false;
+    out.write(w.bytes.data(), static_cast<streamsize>(w.bytes.size()));
+    return out.good();
+}
+
+// Returns false if the file is missing, truncated or from another format version
+bool readModuleFile(const string &path, Module &module)
+{
+    MappedFile file(path);
+    if (!file.valid())
+        return false;
+
+    ModuleReader r(file.data(), file.size());
+
+    char magic[sizeof(MODULE_MAGIC)];
+    if (!r.bytes(magic, sizeof(magic)) || memcmp(magic, MODULE_MAGIC, sizeof(magic)) != 0)
+        return false;
+    if (r.u32() != MODULE_VERSION)
+        return false;
+    module.sourcePath = r.str();
+    module.sourceHash = r.u64();
+
+    uint32_t dependencyCount = r.u32();
+    module.dependencies.clear();
+    for (uint32_t i = 0; r.ok && i < dependencyCount; ++i)
+    {
+        ModuleDependency dep;
+        dep.sourcePath = r.str();
+        dep.sourceHash = r.u64();
+        module.dependencies.push_back(dep);
+    }
+
+    uint32_t exportCount = r.u32();
+    module.exports.clear();
+    for (uint32_t i = 0; r.ok && i < exportCount; ++i)
+    {
+        FunctionSignature sig;
+        sig.name = r.str();
+        sig.returnType = static_cast<VarType>(r.u8());
+        uint32_t paramCount = r.u32();
+        for (uint32_t p = 0; r.ok && p < paramCount; ++p)
+        {
+            sig.paramTypes.push_back(static_cast<VarType>(r.u8()));
+            sig.paramNames.push_back(r.str());
+        }
+        module.exports.push_back(sig);
+    }
+
+    module.ast = r.node();
+    return r.ok;
+}
+
+// ---------------------------------------------------------------------------
+// Module loading
+// ---------------------------------------------------------------------------
+
+FunctionSignature signatureOf(const shared_ptr<ASTNode> &function)
+{
+    FunctionSignature sig;
+    sig.name = function->strVal;
+    sig.returnType = function->valueType;
+    for (const auto &arg : function->children)
+    {
+        if (arg->type == NodeType::Argument)
+        {
+            sig.paramTypes.push_back(arg->valueType);
+            sig.paramNames.push_back(arg->strVal);
+        }
+    }
+    return sig;
+}
+
+vector<FunctionSignature> collectExports(const shared_ptr<ASTNode> &program)
+{
+    vector<FunctionSignature> exports;
+    if (!program)
+        return exports;
+
+    for (const auto &child : program->children)
+    {
+        if (child && child->type == NodeType::Function)
+            exports.push_back(signatureOf(child));
+    }
+    return exports;
+}
+
+// Parses a source file with the shared Bison parser, preserving the caller's root
+static shared_ptr<ASTNode> parseFile(const string &path)
+{
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file)
+        return nullptr;
+
+    FILE *savedIn = yyin;
+    int savedLine = yylineno;
+    auto savedRoot = root;
+    auto savedHandler = onTopLevelStatement;
+
+    // Modules are always parsed whole, even when the importer is streamed
+    yyin = file;
+    yylineno = 1;
+    root = nullptr;
+    onTopLevelStatement = nullptr;
+
+    shared_ptr<ASTNode> result = (yyparse() == 0) ? root : nullptr;
+
+    fclose(file);
+    yyin = savedIn;
+    yylineno = savedLine;
+    root = savedRoot;
+    onTopLevelStatement = savedHandler;
+    return result;
+}
+
+ModuleLoader::ModuleLoader(const string &outputDir) : outputDir(outputDir) {}
+
+// Paths of the modules a program imports directly. They are made absolute, so
+// one module reached through different relative paths is loaded once.
+static vector<string> importedPaths(const shared_ptr<ASTNode> &program, const string &importerPath)
+{
+    vector<string> paths;
+    if (!program)
+        return paths;
+
+    filesystem::path baseDir = filesystem::path(importerPath).parent_path();
+    for (const auto &child : program->children)
+    {
+        if (child && child->type == NodeType::Import)
+            paths.push_back(filesystem::absolute(baseDir / child->strVal).lexically_normal().string());
+    }
+    return paths;
+}
+
+bool ModuleLoader::loadImports(const shared_ptr<ASTNode> &program, const string &importerPath)
+{
+    for (const auto &path : importedPaths(program, importerPath))
+    {
+        if (!loadModule(path))
+            return false;
+    }
+    return true;
+}
+
+const Module *ModuleLoader::findLoaded(const string &sourcePath) const
+{
+    for (const auto &module : loaded)
+    {
+        if (module.sourcePath == sourcePath)
+            return &module;
+    }
+    return nullptr;
+}
+
+// Every already loaded module the program imports, directly or through another
+// module, with its current source hash; dependencies come before their importers
+vector<ModuleDependency> ModuleLoader::dependenciesOf(const shared_ptr<ASTNode> &program, const string &importerPath) const
+{
+    vector<ModuleDependency> deps;
+    unordered_set<string> seen;
+    auto add = [&](const ModuleDependency &dep)
+    {
+        if (seen.insert(dep.sourcePath).second)
+            deps.push_back(dep);
+    };
+
+    for (const auto &path : importedPaths(program, importerPath))
+    {
+        const Module *module = findLoaded(path);
+        if (!module)
+            continue; // failed to load
+        for (const auto &dep : module->dependencies)
+            add(dep);
+        add({module->sourcePath, module->sourceHash});
+    }
+    return deps;
+}
+
+bool ModuleLoader::loadModule(const string &sourcePath)
+{
+    if (findLoaded(sourcePath))
+        return true;
+
+    // A module can't be compiled before the modules it imports, so cycles are rejected
+    auto cycleStart = find(loading.begin(), loading.end(), sourcePath);
+    if (cycleStart != loading.end())
+    {
+        cerr << "❌ Error: Import cycle: ";
+        for (auto it = cycleStart; it != loading.end(); ++it)
+            cerr << *it << " -> ";
+        cerr << sourcePath << "\n";
+        return false;
+    }
+    loading.push_back(sourcePath);
+
+    uint64_t hash = hashFile(sourcePath);
+    if (hash == 0)
+    {
+        cerr << "❌ Error: Could not open imported module " << sourcePath << "\n";
+        return false;
+    }
+
+    // Artifacts are named after the file plus a hash of its full path, so modules
+    // with the same name in different directories don't overwrite each other
+    char pathHash[17];
+    snprintf(pathHash, sizeof(pathHash), "%016llx",
+             static_cast<unsigned long long>(fnv1a(FNV_OFFSET, sourcePath.data(), sourcePath.size())));
+    string artifactBase = (filesystem::path(outputDir) /
+                           (filesystem::path(sourcePath).stem().string() + "-" + pathHash)).string();
+    string bacmPath = artifactBase + ".bacm";
+
+    Module module;
+    module.objectPath = artifactBase + ".o";
+
+    // Reuse the precompiled module only if both it and its object code are current
+    bool upToDate = readModuleFile(bacmPath, module) && module.sourcePath == sourcePath &&
+                    module.sourceHash == hash && filesystem::exists(module.objectPath);
+    module.sourcePath = sourcePath;
+    if (upToDate)
+    {
+        // Dependencies must be linked too, and come before this module. Loading
+        // them rebuilds any that changed, which makes this module stale as well.
+        if (!loadImports(module.ast, sourcePath))
+            return false;
+        upToDate = module.dependencies == dependenciesOf(module.ast, sourcePath);
+    }
+
+    if (upToDate)
+        cout << "📦 Using precompiled module " << bacmPath << "\n";
+    else if (!buildModule(sourcePath, hash, artifactBase, module))
+        return false;
+
+    loading.pop_back();
+    loaded.push_back(module);
+    return true;
+}
+
+bool ModuleLoader::buildModule(const string &sourcePath, uint64_t hash, const string &artifactBase, Module &module)
+{
+    string bacmPath = artifactBase + ".bacm";
+    cout << "🔨 Building module " << sourcePath << "...\n";
+
+    auto ast = parseFile(sourcePath);
+    if (!ast)
+    {
+        cerr << "❌ Error: Failed to parse imported module " << sourcePath << "\n";
+        return false;
+    }
+
+    module.sourceHash = hash;
+    module.ast = ast;
+    module.exports = collectExports(ast);
+
+    // Dependencies are built first so their prototypes can be emitted here
+    if (!loadImports(ast, sourcePath))
+        return false;
+    module.dependencies = dependenciesOf(ast, sourcePath);
+
+    // The cached AST is the source-level one; optimizations only affect the object code
+    if (!writeModuleFile(bacmPath, module))
+        cerr << "⚠️  Warning: Could not write module cache " << bacmPath << "\n";
+
+    auto optimized = optimizedAst(module);
+
+    // Emit and compile the module's C once; importers only link the object file
+    string cFile = artifactBase + ".c";
+    CodeGenerator codegen;
+    for (const auto &dep : module.dependencies)
+        for (const auto &sig : findLoaded(dep.sourcePath)->exports)
+            codegen.declareExtern(sig);
+    codegen.generate(optimized, cFile);
+
+    string compileCmd = "gcc -c \"" + cFile + "\" -o \"" + module.objectPath + "\"";
+    if (system(compileCmd.c_str()) != 0)
+    {
+        cerr << "❌ Error: Failed to compile module " << sourcePath << "\n";
+        filesystem::remove(bacmPath);
+        return false;
+    }
+
+    return true;
+}
+
+shared_ptr<ASTNode> ModuleLoader::optimizedAst(const Module &module) const
+{
+    // The optimizer rewrites in place, so it works on a copy of the cached tree
+    auto optimized = module.ast->clone();
+    Optimizer optimizer;
+    for (const auto &dep : module.dependencies)
+        optimizer.addLibrary(findLoaded(dep.sourcePath)->ast);
+    optimizer.optimize(optimized);
+    return optimized;
+}
@@ -0,0 +1,484 @@
+// AST optimization passes
+#include "optimizer.h"
+#include "evaluator.h"
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Upper bound on interpreter steps spent folding a single call
+static const long FOLD_STEP_BUDGET = 1000000;
+
+Optimizer::Optimizer() {}
+
+void Optimizer::addLibrary(const shared_ptr<ASTNode> &module)
+{
+    if (module)
+        libraries.push_back(module);
+}
+
+// Runs every pass over the program
+void Optimizer::optimize(const shared_ptr<ASTNode> &program)
+{
+    if (!program)
+        return;
+
+    int folded = foldPureCalls(program);
+    if (folded > 0)
+    {
+        cout << "⚡ Evaluated " << folded << " pure function call(s) at compile time\n";
+    }
+
+    for (const auto &child : program->children)
+        optimizeStatement(child);
+}
+
+// Runs the local passes over one top-level statement
+void Optimizer::optimizeStatement(const shared_ptr<ASTNode> &statement)
+{
+    if (!statement)
+        return;
+
+    int rebalanced = rebalanceChains(statement);
+    if (rebalanced > 0)
+    {
+        cout << "🌲 Rebalanced " << rebalanced << " long operator chain(s)\n";
+    }
+
+    if (statement->type == NodeType::Function && eliminateTailCalls(statement))
+    {
+        cout << "🔁 Rewrote tail recursion in `" << statement->strVal << "` as a loop\n";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Shared helpers
+// ---------------------------------------------------------------------------
+
+// An operand that may be folded into an integer accumulator: no calls, no floats,
+// so evaluating it earlier and reassociating cannot change the result
+static bool isAccumulable(const shared_ptr<ASTNode> &operand)
+{
+    vector<const ASTNode *> pending = {operand.get()};
+    while (!pending.empty())
+    {
+        const ASTNode *node = pending.back();
+        pending.pop_back();
+        if (!node)
+            return false;
+
+        switch (node->type)
+        {
+        case NodeType::IntLiteral:
+            break;
+        case NodeType::Identifier:
+            if (node->valueType == VarType::Float)
+                return false;
+            break;
+        case NodeType::BinaryOp:
+            if (node->strVal != "+" && node->strVal != "-" && node->strVal != "*")
+                return false;
+            pending.push_back(node->left.get());
+            pending.push_back(node->right.get());
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Compile-time evaluation of pure calls
+// ---------------------------------------------------------------------------
+
+// Converts a literal argument to the int the generated C would pass
+static bool literalArgument(const shared_ptr<ASTNode> &arg, int &value)
+{
+    if (!arg)
+        return false;
+    if (arg->type == NodeType::IntLiteral)
+    {
+        value = arg->intVal;
+        return true;
+    }
+    // Parameters are ints, so C truncates float arguments toward zero
+    if (arg->type == NodeType::FloatLiteral && isfinite(arg->floatVal) &&
+        arg->floatVal > static_cast<float>(INT_MIN) && arg->floatVal < static_cast<float>(INT_MAX))
+    {
+        value = static_cast<int>(arg->floatVal);
+        return true;
+    }
+    return false;
+}
+
+// Calls are visited innermost first, so `f(g(1), 2)` folds g before f
+int Optimizer::foldPureCalls(const shared_ptr<ASTNode> &program)
+{
+    ConstEvaluator evaluator(FOLD_STEP_BUDGET);
+    for (const auto &library : libraries)
+        evaluator.addFunctions(library);
+    evaluator.addFunctions(program);
+    evaluator.analyzePurity();
+
+    vector<ASTNode *> calls;
+    vector<ASTNode *> pending = {program.get()};
+    while (!pending.empty())
+    {
+        ASTNode *node = pending.back();
+        pending.pop_back();
+        if (!node)
+            continue;
+        if (node->type == NodeType::FunctionCall && evaluator.isPure(node->strVal))
+            calls.push_back(node);
+        pending.push_back(node->left.get());
+        pending.push_back(node->right.get());
+        for (const auto &child : node->children)
+            pending.push_back(child.get());
+    }
+
+    int folded = 0;
+    for (auto it = calls.rbegin(); it != calls.rend(); ++it)
+    {
+        ASTNode *call = *it;
+
+        vector<int> args;
+        string argText;
+        bool constant = true;
+        for (const auto &arg : call->children)
+        {
+            int value = 0;
+            if (!literalArgument(arg, value))
+            {
+                constant = false;
+                break;
+            }
+            args.push_back(value);
+            argText += (argText.empty() ? "" : ", ") + arg->getLiteralAsString();
+        }
+
+        int result = 0;
+        long steps = 0;
+        if (!constant || !evaluator.evaluate(call->strVal, args, result, steps))
+            continue;
+
+        cout << "⚡ " << call->strVal << "(" << argText << ") = " << result << " (" << steps << " steps)\n";
+
+        call->type = NodeType::IntLiteral;
+        call->valueType = VarType::Int;
+        call->intVal = result;
+        call->strVal.clear();
+        call->children.clear();
+        ++folded;
+    }
+    return folded;
+}
+
+// ---------------------------------------------------------------------------
+// Chain rebalancing
+// ---------------------------------------------------------------------------
+
+// Chains shorter than this are left as written
+static const size_t MIN_CHAIN_LENGTH = 64;
+
+// Builds a balanced tree over leaves[lo, hi); depth is only log2 of the chain length
+static shared_ptr<ASTNode> buildBalanced(const string &op, const vector<shared_ptr<ASTNode>> &leaves, size_t lo, size_t hi)
+{
+    if (hi - lo == 1)
+        return leaves[lo];
+    size_t mid = lo + (hi - lo) / 2;
+    return make_shared<ASTNode>(NodeType::BinaryOp, op, buildBalanced(op, leaves, lo, mid),
+                                buildBalanced(op, leaves, mid, hi));
+}
+
+// Wraps each operand in a C cast, e.g. `(unsigned)a`
+static vector<shared_ptr<ASTNode>> castAll(const string &type, const vector<shared_ptr<ASTNode>> &operands)
+{
+    vector<shared_ptr<ASTNode>> casts;
+    for (const auto &operand : operands)
+    {
+        auto cast = make_shared<ASTNode>(NodeType::UnaryOp, "(" + type + ")");
+        cast->children.push_back(operand);
+        casts.push_back(cast);
+    }
+    return casts;
+}
+
+// The parser builds `a + b + c + ...` as a left-leaning tree as deep as the chain
+// is long. Such chains are regrouped into balanced trees, keeping every later
+// walk (and the C compiler) shallow. Chains mixing + and - are regrouped as
+// (sum of added terms) - (sum of subtracted terms). Chains with float or call
+// operands are left alone since regrouping could change them; / and % chains
+// can't be regrouped at all.
+//
+// Signed int arithmetic isn't associative in C: a regrouped chain can overflow,
+// which is undefined, where the source didn't. So the regrouped chain is computed
+// on unsigned operands, which wrap, and converted back to int, giving the same
+// result as the source whenever the source's result is defined.
+int Optimizer::rebalanceChains(const shared_ptr<ASTNode> &program)
+{
+    int rebalanced = 0;
+    vector<ASTNode *> pending = {program.get()};
+
+    while (!pending.empty())
+    {
+        ASTNode *node = pending.back();
+        pending.pop_back();
+        if (!node)
+            continue;
+
+        bool additive = node->type == NodeType::BinaryOp && (node->strVal == "+" || node->strVal == "-");
+        bool multiplicative = node->type == NodeType::BinaryOp && node->strVal == "*";
+        if (!additive && !multiplicative)
+        {
+            pending.push_back(node->left.get());
+            pending.push_back(node->right.get());
+            for (const auto &child : node->children)
+                pending.push_back(child.get());
+            continue;
+        }
+
+        // Flatten the maximal subtree of this kind into its operands, in order,
+        // split by whether each one ends up added or subtracted
+        auto inChain = [&](const shared_ptr<ASTNode> &n)
+        {
+            return n && n->type == NodeType::BinaryOp &&
+                   (additive ? (n->strVal == "+" || n->strVal == "-") : n->strVal == "*");
+        };
+        vector<shared_ptr<ASTNode>> added, subtracted;
+        vector<pair<shared_ptr<ASTNode>, bool>> walk = {{node->right, node->strVal == "-"}, {node->left, false}};
+        while (!walk.empty())
+        {
+            auto [current, negated] = walk.back();
+            walk.pop_back();
+            if (inChain(current))
+            {
+                walk.push_back({current->right, negated != (current->strVal == "-")});
+                walk.push_back({current->left, negated});
+            }
+            else
+            {
+                (negated ? subtracted : added).push_back(current);
+            }
+        }
+
+        bool safe = added.size() + subtracted.size() >= MIN_CHAIN_LENGTH;
+        for (size_t i = 0; safe && i < added.size(); ++i)
+            safe = isAccumulable(added[i]);
+        for (size_t i = 0; safe && i < subtracted.size(); ++i)
+            safe = isAccumulable(subtracted[i]);
+
+        if (safe)
+        {
+            auto unsignedAdded = castAll("unsigned", added);
+            auto unsignedSubtracted = castAll("unsigned", subtracted);
+            shared_ptr<ASTNode> chain;
+            if (subtracted.empty())
+                chain = buildBalanced(node->strVal, unsignedAdded, 0, added.size());
+            else
+                chain = make_shared<ASTNode>(NodeType::BinaryOp, "-",
+                                             buildBalanced("+", unsignedAdded, 0, added.size()),
+                                             buildBalanced("+", unsignedSubtracted, 0, subtracted.size()));
+
+            node->type = NodeType::UnaryOp;
+            node->strVal = "(int)";
+            node->left = nullptr;
+            node->right = nullptr;
+            node->children = {chain};
+            ++rebalanced;
+        }
+
+        for (const auto &leaf : added)
+            pending.push_back(leaf.get());
+        for (const auto &leaf : subtracted)
+            pending.push_back(leaf.get());
+    }
+    return rebalanced;
+}
+
+// ---------------------------------------------------------------------------
+// Tail call elimination
+// ---------------------------------------------------------------------------
+
+// A call to `name` with exactly `arity` arguments
+static bool isSelfCall(const shared_ptr<ASTNode> &node, const string &name, size_t arity)
+{
+    return node && node->type == NodeType::FunctionCall && node->strVal == name &&
+           node->children.size() == arity;
+}
+
+// Collects Return nodes of a function body in source order, without entering nested functions.
+// Each one is paired with whether a declaration in an enclosing block or loop shadows a parameter.
+static void collectReturns(const shared_ptr<ASTNode> &body, const vector<shared_ptr<ASTNode>> &params,
+                           vector<pair<shared_ptr<ASTNode>, bool>> &returns)
+{
+    auto declaresParam = [&](const shared_ptr<ASTNode> &node)
+    {
+        for (const auto &child : node->children)
+            if (child && child->type == NodeType::Declaration)
+                for (const auto &param : params)
+                    if (child->strVal == param->strVal)
+                        return true;
+        return false;
+    };
+
+    vector<pair<shared_ptr<ASTNode>, bool>> pending = {{body, false}};
+    while (!pending.empty())
+    {
+        auto [node, shadowed] = pending.back();
+        pending.pop_back();
+
+        if (!node || node->type == NodeType::Function)
+            continue;
+        if (node->type == NodeType::Return)
+        {
+            returns.push_back({node, shadowed});
+            continue;
+        }
+        shadowed = shadowed || declaresParam(node);
+        for (auto child = node->children.rbegin(); child != node->children.rend(); ++child)
+            pending.push_back({*child, shadowed});
+    }
+}
+
+// Detects `return f(...)` and `return e op f(...)` (op being + or *) inside f and
+// rewrites them as parameter reassignment followed by a jump back to the top of
+// the body. Accumulator-style returns are only converted when every one of them
+// uses the same operator and `e` is a side-effect free integer expression. A
+// function is left alone if a local declaration shadows a parameter around any
+// self call, since the reassignment would write the local instead.
+bool Optimizer::eliminateTailCalls(const shared_ptr<ASTNode> &function)
+{
+    const string &name = function->strVal;
+
+    vector<shared_ptr<ASTNode>> params;
+    shared_ptr<ASTNode> body;
+    for (const auto &child : function->children)
+    {
+        if (child->type == NodeType::Argument)
+            params.push_back(child);
+        else if (child->type == NodeType::Block)
+            body = child;
+    }
+    if (!body)
+        return false;
+
+    vector<pair<shared_ptr<ASTNode>, bool>> returns;
+    collectReturns(body, params, returns);
+
+    // Classify each return: plain tail call, accumulating call, or base case
+    vector<shared_ptr<ASTNode>> tailReturns, accReturns, baseReturns;
+    string accOp;
+    bool accSafe = true;
+    for (const auto &[ret, shadowed] : returns)
+    {
+        const auto value = ret->children.empty() ? nullptr : ret->children[0];
+
+        if (isSelfCall(value, name, params.size()))
+        {
+            if (shadowed)
+                return false;
+            tailReturns.push_back(ret);
+        }
+        else if (value && value->type == NodeType::BinaryOp && (value->strVal == "+" || value->strVal == "*") &&
+                 (isSelfCall(value->left, name, params.size()) || isSelfCall(value->right, name, params.size())))
+        {
+            if (shadowed)
+                return false;
+            auto operand = isSelfCall(value->right, name, params.size()) ? value->left : value->right;
+            if (!isAccumulable(operand) || (!accOp.empty() && accOp != value->strVal))
+                accSafe = false;
+            accOp = value->strVal;
+            accReturns.push_back(ret);
+        }
+        else
+        {
+            baseReturns.push_back(ret);
+        }
+    }
+
+    bool useAccumulator = !accReturns.empty() && accSafe;
+    if (tailReturns.empty() && !useAccumulator)
+        return false;
+
+    const string label = "__bac_tail_" + name;
+    const string acc = "__bac_acc_" + name;
+
+    // Turns a return of a self call into: fold operand into accumulator, reassign parameters, jump
+    auto rewriteAsJump = [&](const shared_ptr<ASTNode> &ret, const shared_ptr<ASTNode> &call,
+                             const shared_ptr<ASTNode> &operand)
+    {
+        vector<shared_ptr<ASTNode>> stmts;
+
+        if (operand)
+        {
+            auto update = make_shared<ASTNode>(NodeType::Assignment, acc);
+            update->children.push_back(make_shared<ASTNode>(
+                NodeType::BinaryOp, accOp, make_shared<ASTNode>(NodeType::Identifier, acc), operand));
+            stmts.push_back(update);
+        }
+
+        // Evaluate every argument before assigning any parameter
+        vector<size_t> changed;
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+            const auto &arg = call->children[i];
+            if (arg && arg->type == NodeType::Identifier && arg->strVal == params[i]->strVal)
+                continue;
+
+            auto temp = make_shared<ASTNode>(NodeType::Declaration, "__bac_tmp_" + to_string(i));
+            temp->children.push_back(arg);
+            temp->valueType = arg ? arg->valueType : VarType::Int;
+            stmts.push_back(temp);
+            changed.push_back(i);
+        }
+        for (size_t i : changed)
+        {
+            auto assign = make_shared<ASTNode>(NodeType::Assignment, params[i]->strVal);
+            assign->children.push_back(make_shared<ASTNode>(NodeType::Identifier, "__bac_tmp_" + to_string(i)));
+            stmts.push_back(assign);
+        }
+
+        stmts.push_back(make_shared<ASTNode>(NodeType::Goto, label));
+
+        ret->type = NodeType::Block;
+        ret->children = stmts;
+    };
+
+    for (const auto &ret : tailReturns)
+        rewriteAsJump(ret, ret->children[0], nullptr);
+
+    if (useAccumulator)
+    {
+        for (const auto &ret : accReturns)
+        {
+            auto value = ret->children[0];
+            bool callOnRight = isSelfCall(value->right, name, params.size());
+            rewriteAsJump(ret, callOnRight ? value->right : value->left, callOnRight ? value->left : value->right);
+        }
+
+        // Base cases combine their value with everything accumulated so far
+        for (const auto &ret : baseReturns)
+        {
+            if (ret->children.empty())
+                continue;
+            ret->children[0] = make_shared<ASTNode>(
+                NodeType::BinaryOp, accOp, make_shared<ASTNode>(NodeType::Identifier, acc), ret->children[0]);
+        }
+    }
+
+    // Function entry: accumulator starts at the operator's identity, then the loop label
+    vector<shared_ptr<ASTNode>> prologue;
+    if (useAccumulator)
+    {
+        auto init = make_shared<ASTNode>(NodeType::Declaration, acc);
+        init->children.push_back(make_shared<ASTNode>(NodeType::IntLiteral, accOp == "*" ? 1 : 0));
+        prologue.push_back(init);
+    }
+    prologue.push_back(make_shared<ASTNode>(NodeType::Label, label));
+    body->children.insert(body->children.begin(), prologue.begin(), prologue.end());
+
+    return true;
+}
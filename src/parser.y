@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
@@ -10,6 +11,10 @@
 #include "../include/symboltable.h"
 #include "../include/error.h"
 
+// Deeply nested blocks and parentheses need a much larger parser stack than
+// Bison's default of 10000 entries; it still grows on demand from YYINITDEPTH.
+#define YYMAXDEPTH 50000000
+
 using ASTNodePtr = std::shared_ptr<ASTNode>;
 using ASTNodeList = std::vector<ASTNodePtr>;
 
@@ -19,6 +24,15 @@ int yyerror(const char *msg);
 
 ASTNodePtr root = nullptr;
 SymbolTable symbolTable;  // Global symbol table instance
+std::function<bool(const ASTNodePtr&)> onTopLevelStatement;
+
+// Offers a finished top-level statement to the streaming backend, keeping it otherwise
+static void addTopLevel(ASTNodeList* list, ASTNodePtr* stmt) {
+    if (!onTopLevelStatement || !onTopLevelStatement(*stmt)) {
+        list->push_back(*stmt);
+    }
+    delete stmt;
+}
 %}
 
 %union {
@@ -34,9 +48,11 @@ SymbolTable symbolTable;  // Global symbol table instance
 %token <floatVal> FLOAT_LITERAL
 %token <boolean> BOOLEAN_LITERAL
 %token PRINT
+%token IMPORT
 
 
-%token LET IF ELSE WHILE FOR RETURN FUNC
+%token <intVal> IF WHILE FOR RETURN FUNC   /* value is the source line */
+%token LET ELSE
 %token INT_TYPE FLOAT_TYPE BOOL_TYPE STRING_TYPE VOID_TYPE
 %token EQ NEQ LE GE LT GT
 %token AND OR NOT
@@ -53,14 +69,14 @@ SymbolTable symbolTable;  // Global symbol table instance
 %left MUL DIV MOD
 %right NOT
 
-%type <ptr> program statement expression block declaration assignment function call return_stmt if_stmt while_stmt for_stmt
-%type <ptr> statements args opt_args call_args opt_call_args
+%type <ptr> program statement expression block declaration assignment function call return_stmt if_stmt while_stmt for_stmt import_stmt
+%type <ptr> top_level top_statement statements args opt_args call_args opt_call_args
 
 %start program
 %%
 
 program:
-    statements {
+    top_level {
         root = std::make_shared<ASTNode>(NodeType::Program);
         auto list = static_cast<ASTNodeList*>($1);
         root->children = *list;
@@ -68,6 +84,25 @@ program:
     }
 ;
 
+top_level:
+    top_statement {
+        auto list = new ASTNodeList();
+        addTopLevel(list, static_cast<ASTNodePtr*>($1));
+        $$ = list;
+    }
+    | top_level top_statement {
+        auto list = static_cast<ASTNodeList*>($1);
+        addTopLevel(list, static_cast<ASTNodePtr*>($2));
+        $$ = list;
+    }
+;
+
+/* Imports are resolved per file, so they may only appear at top level */
+top_statement:
+      statement                   { $$ = $1; }
+    | import_stmt SEMICOLON       { $$ = $1; }
+;
+
 statements:
     statement {
         auto list = new ASTNodeList();
@@ -97,6 +132,7 @@ statement:
     | block                       { $$ = $1; }
     | PRINT LPAREN expression RPAREN SEMICOLON {
     auto node = std::make_shared<ASTNode>(NodeType::FunctionCall, std::string("print")); 
+    node->line = yylineno;
     node->children.push_back(*static_cast<ASTNodePtr*>($3));
     $$ = new ASTNodePtr(node);
     delete static_cast<ASTNodePtr*>($3);
@@ -119,6 +155,7 @@ block:
 declaration:
     LET IDENTIFIER ASSIGN expression {
         auto node = std::make_shared<ASTNode>(NodeType::Declaration, std::string($2));
+        node->line = yylineno;
         auto expr = *static_cast<ASTNodePtr*>($4);
         node->children.push_back(expr);
         node->valueType = expr->valueType;  // Inherit type from the expression
@@ -126,6 +163,7 @@ declaration:
         // Add to symbol table with proper type
         symbolTable.declare(std::string($2), expr->valueType, SymbolType::Variable);
         
+        free($2);  // since strdup() was used in lexer
         delete static_cast<ASTNodePtr*>($4);
         $$ = new ASTNodePtr(node);
     }
@@ -135,6 +173,8 @@ declaration:
 assignment:
     IDENTIFIER ASSIGN expression {
         auto node = std::make_shared<ASTNode>(NodeType::Assignment, std::string($1));
+        node->line = yylineno;
+        free($1);
         node->children.push_back(*static_cast<ASTNodePtr*>($3));
         delete static_cast<ASTNodePtr*>($3);
         $$ = new ASTNodePtr(node);
@@ -145,6 +185,8 @@ assignment:
 function:
     FUNC IDENTIFIER LPAREN opt_args RPAREN block {
         auto node = std::make_shared<ASTNode>(NodeType::Function, std::string($2));
+        node->line = $1;
+        free($2);
         auto args = static_cast<ASTNodeList*>($4);
         for (auto& arg : *args) node->children.push_back(arg);
         delete args;
@@ -155,6 +197,20 @@ function:
 ;
 
 
+import_stmt:
+    IMPORT STRING_LITERAL {
+        std::string path($2);
+        if (path.length() >= 2 && path.front() == '"' && path.back() == '"') {
+            path = path.substr(1, path.length() - 2);  // remove surrounding quotes
+        }
+        auto node = std::make_shared<ASTNode>(NodeType::Import, path);
+        node->line = yylineno;
+        $$ = new ASTNodePtr(node);
+        free($2);
+    }
+;
+
+
 opt_args:
     /* empty */ { $$ = new ASTNodeList(); }
     | args      { $$ = $1; }
@@ -164,11 +220,13 @@ args:
     LET IDENTIFIER {
         auto list = new ASTNodeList();
         list->push_back(std::make_shared<ASTNode>(NodeType::Argument, std::string($2)));
+        free($2);
         $$ = list;
     }
     | args COMMA LET IDENTIFIER {
         auto list = static_cast<ASTNodeList*>($1);
         list->push_back(std::make_shared<ASTNode>(NodeType::Argument, std::string($4)));
+        free($4);
         $$ = list;
     }
 ;
@@ -177,6 +235,7 @@ args:
 return_stmt:
     RETURN expression {
         auto node = std::make_shared<ASTNode>(NodeType::Return);
+        node->line = $1;
         node->children.push_back(*static_cast<ASTNodePtr*>($2));
         delete static_cast<ASTNodePtr*>($2);
         $$ = new ASTNodePtr(node);
@@ -186,6 +245,7 @@ return_stmt:
 if_stmt:
     IF LPAREN expression RPAREN block {
         auto node = std::make_shared<ASTNode>(NodeType::If);
+        node->line = $1;
         node->children.push_back(*static_cast<ASTNodePtr*>($3));
         node->children.push_back(*static_cast<ASTNodePtr*>($5));
         delete static_cast<ASTNodePtr*>($3);
@@ -194,6 +254,7 @@ if_stmt:
     }
     | IF LPAREN expression RPAREN block ELSE block {
         auto node = std::make_shared<ASTNode>(NodeType::IfElse);
+        node->line = $1;
         node->children.push_back(*static_cast<ASTNodePtr*>($3));
         node->children.push_back(*static_cast<ASTNodePtr*>($5));
         node->children.push_back(*static_cast<ASTNodePtr*>($7));
@@ -207,6 +268,7 @@ if_stmt:
 while_stmt:
     WHILE LPAREN expression RPAREN block {
         auto node = std::make_shared<ASTNode>(NodeType::While);
+        node->line = $1;
         node->children.push_back(*static_cast<ASTNodePtr*>($3)); // condition
         node->children.push_back(*static_cast<ASTNodePtr*>($5)); // body
         delete static_cast<ASTNodePtr*>($3);
@@ -219,6 +281,7 @@ while_stmt:
 for_stmt:
     FOR LPAREN assignment SEMICOLON expression SEMICOLON assignment RPAREN block {
         auto node = std::make_shared<ASTNode>(NodeType::For);
+        node->line = $1;
         node->children.push_back(*static_cast<ASTNodePtr*>($3)); // init (assignment)
         node->children.push_back(*static_cast<ASTNodePtr*>($5)); // condition (expression)
         node->children.push_back(*static_cast<ASTNodePtr*>($7)); // update (assignment)
@@ -252,6 +315,7 @@ expression:
         if (symbol) {
             ident->valueType = symbol->type;
         }
+        free($1);
         $$ = new ASTNodePtr(ident);
     }
     | expression PLUS expression {
@@ -301,6 +365,7 @@ call:
             $$ = new ASTNodePtr(nullptr);
         } else {
             auto node = std::make_shared<ASTNode>(NodeType::FunctionCall, std::string($1));
+            node->line = yylineno;
             auto args = static_cast<ASTNodeList*>($3);
             for (auto& arg : *args) {
                 node->children.push_back(arg);
@@ -308,6 +373,7 @@ call:
             delete args;
             $$ = new ASTNodePtr(node);
         }
+        free($1);
     }
 ;
 
@@ -0,0 +1,215 @@
+// Runtime support emitted into programs compiled with --profile
+#include "profiler.h"
+
+using namespace std;
+
+// Escapes a string for use inside a C string literal
+static string cStringLiteral(const string &text)
+{
+    string escaped = "\"";
+    for (char c : text)
+    {
+        if (c == '\\' || c == '"')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+// Sites keep counters and self/total time; a calling-context tree (one node per
+// distinct stack of sites) provides the folded stacks. Time is measured with the
+// cycle counter where available, falling back to clock().
+static const char *PROFILER_RUNTIME = R"(/* --- BasicCode profiler runtime --- */
+#include <stdlib.h>
+#include <time.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BAC_PROF_NOW() __rdtsc()
+#define BAC_PROF_UNIT "cycles"
+#else
+#define BAC_PROF_NOW() ((unsigned long long)clock())
+#define BAC_PROF_UNIT "clock ticks"
+#endif
+
+#define BAC_PROF_MAX_NODES 65536
+
+typedef struct {
+    const char *name;
+    const char *kind;
+    int line;
+    unsigned long long calls, iterations, self, total;
+    int active;
+} bac_prof_site;
+
+typedef struct {
+    int site, node;
+    unsigned long long start, child;
+} bac_prof_frame;
+
+typedef struct {
+    int site, parent;
+    unsigned long long self;
+} bac_prof_node;
+
+extern bac_prof_site bac_prof_sites[];
+extern const int bac_prof_site_count;
+
+static bac_prof_frame *bac_prof_stack;
+static int bac_prof_depth, bac_prof_capacity;
+static bac_prof_node bac_prof_nodes[BAC_PROF_MAX_NODES] = {{-1, -1, 0}};
+static int bac_prof_node_count = 1;
+static int bac_prof_index[2 * BAC_PROF_MAX_NODES]; /* (parent, site) -> node + 1 */
+
+/* Finds or creates the context-tree node for `site` called under `parent` */
+static int bac_prof_child(int parent, int site)
+{
+    unsigned h = ((unsigned)parent * 31u + (unsigned)site) * 2654435761u % (2 * BAC_PROF_MAX_NODES);
+    while (bac_prof_index[h]) {
+        int node = bac_prof_index[h] - 1;
+        if (bac_prof_nodes[node].parent == parent && bac_prof_nodes[node].site == site)
+            return node;
+        h = (h + 1) % (2 * BAC_PROF_MAX_NODES);
+    }
+    if (bac_prof_node_count == BAC_PROF_MAX_NODES)
+        return parent; /* tree full: charge the caller */
+    bac_prof_nodes[bac_prof_node_count].site = site;
+    bac_prof_nodes[bac_prof_node_count].parent = parent;
+    bac_prof_index[h] = bac_prof_node_count + 1;
+    return bac_prof_node_count++;
+}
+
+static void bac_prof_enter(int site)
+{
+    bac_prof_frame *f;
+    if (bac_prof_depth == bac_prof_capacity) {
+        bac_prof_capacity = bac_prof_capacity ? 2 * bac_prof_capacity : 256;
+        bac_prof_stack = (bac_prof_frame *)realloc(bac_prof_stack, bac_prof_capacity * sizeof(bac_prof_frame));
+    }
+    f = &bac_prof_stack[bac_prof_depth];
+    f->site = site;
+    f->node = bac_prof_child(bac_prof_depth ? bac_prof_stack[bac_prof_depth - 1].node : 0, site);
+    f->child = 0;
+    bac_prof_sites[site].calls++;
+    bac_prof_sites[site].active++;
+    bac_prof_depth++;
+    f->start = BAC_PROF_NOW();
+}
+
+static void bac_prof_pop(void)
+{
+    bac_prof_frame *f = &bac_prof_stack[--bac_prof_depth];
+    bac_prof_site *s = &bac_prof_sites[f->site];
+    unsigned long long elapsed = BAC_PROF_NOW() - f->start;
+    unsigned long long self = elapsed > f->child ? elapsed - f->child : 0;
+    s->self += self;
+    bac_prof_nodes[f->node].self += self;
+    if (--s->active == 0)
+        s->total += elapsed; /* outermost activation only, so recursion isn't counted twice */
+    if (bac_prof_depth)
+        bac_prof_stack[bac_prof_depth - 1].child += elapsed;
+}
+
+/* Leaves `site`, closing any loops still open inside it (e.g. on return) */
+static void bac_prof_leave(int site)
+{
+    while (bac_prof_depth) {
+        int top = bac_prof_stack[bac_prof_depth - 1].site;
+        bac_prof_pop();
+        if (top == site)
+            break;
+    }
+}
+
+/* Closes loops open inside `site` but stays in it (tail call turned into a jump) */
+static void bac_prof_unwind(int site)
+{
+    while (bac_prof_depth && bac_prof_stack[bac_prof_depth - 1].site != site)
+        bac_prof_pop();
+}
+
+static int bac_prof_by_self(const void *a, const void *b)
+{
+    const bac_prof_site *x = &bac_prof_sites[*(const int *)a];
+    const bac_prof_site *y = &bac_prof_sites[*(const int *)b];
+    return (x->self < y->self) - (x->self > y->self);
+}
+
+static void bac_prof_write_report(FILE *out, const int *order, unsigned long long grand)
+{
+    int i;
+    fprintf(out, "BasicCode profile (times in " BAC_PROF_UNIT ")\n");
+    fprintf(out, "%8s %16s %16s %12s %12s  %s\n", "self%", "self", "total", "calls", "iterations", "site");
+    for (i = 0; i < bac_prof_site_count; ++i) {
+        const bac_prof_site *s = &bac_prof_sites[order[i]];
+        if (!s->calls)
+            continue;
+        fprintf(out, "%7.2f%% %16llu %16llu %12llu %12llu  %s %s (line %d)\n",
+                grand ? 100.0 * s->self / grand : 0.0, s->self, s->total, s->calls, s->iterations,
+                s->kind, s->name, s->line);
+    }
+}
+
+static void bac_prof_report(void)
+{
+    int i, *order, *path;
+    unsigned long long grand = 0;
+    FILE *out;
+
+    while (bac_prof_depth)
+        bac_prof_pop();
+
+    order = (int *)malloc((bac_prof_site_count + 1) * sizeof(int));
+    for (i = 0; i < bac_prof_site_count; ++i) {
+        order[i] = i;
+        grand += bac_prof_sites[i].self;
+    }
+    qsort(order, bac_prof_site_count, sizeof(int), bac_prof_by_self);
+
+    fprintf(stderr, "\n");
+    bac_prof_write_report(stderr, order, grand);
+    if ((out = fopen(BAC_PROF_REPORT, "w")) != NULL) {
+        bac_prof_write_report(out, order, grand);
+        fclose(out);
+    }
+
+    /* One line per distinct stack: "main;fib;while@12 <self time>" */
+    path = (int *)malloc(bac_prof_node_count * sizeof(int));
+    if ((out = fopen(BAC_PROF_FOLDED, "w")) != NULL) {
+        for (i = 1; i < bac_prof_node_count; ++i) {
+            int depth = 0, node = i;
+            if (!bac_prof_nodes[i].self)
+                continue;
+            while (node > 0) {
+                path[depth++] = bac_prof_nodes[node].site;
+                node = bac_prof_nodes[node].parent;
+            }
+            while (depth--)
+                fprintf(out, "%s%s", bac_prof_sites[path[depth]].name, depth ? ";" : "");
+            fprintf(out, " %llu\n", bac_prof_nodes[i].self);
+        }
+        fclose(out);
+    }
+    free(path);
+    free(order);
+}
+/* --- end of profiler runtime --- */
+
+)";
+
+void writeProfilerRuntime(ostream &out, const string &reportFile, const string &foldedFile)
+{
+    out << "#define BAC_PROF_REPORT " << cStringLiteral(reportFile) << "\n";
+    out << "#define BAC_PROF_FOLDED " << cStringLiteral(foldedFile) << "\n";
+    out << PROFILER_RUNTIME;
+}
+
+void writeProfilerSites(ostream &out, const vector<ProfileSite> &sites)
+{
+    out << "\nbac_prof_site bac_prof_sites[] = {\n";
+    for (const auto &site : sites)
+        out << "    {" << cStringLiteral(site.name) << ", " << cStringLiteral(site.kind) << ", " << site.line << "},\n";
+    if (sites.empty())
+        out << "    {0},\n";
+    out << "};\n";
+    out << "const int bac_prof_site_count = " << sites.size() << ";\n";
+}
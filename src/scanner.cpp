@@ -0,0 +1,541 @@
+// Hand-written scanner, a faster drop-in replacement for the Flex lexer (lexer.l).
+// Selected at build time with -DBAC_HANDWRITTEN_LEXER=ON.
+//
+// It must produce exactly the tokens, values and line numbers of lexer.l, quirks
+// included: newlines inside string literals and block comments are not counted,
+// an unterminated string or comment falls back to single-character tokens, and
+// every other unknown byte is reported and returned as INVALID.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "parser.tab.h"
+#include "error.h"
+
+using namespace std;
+
+FILE *yyin = nullptr;
+int yylineno = 1;
+
+// ---------------------------------------------------------------------------
+// Keywords: a perfect hash on (length, first char, last char), checked for
+// collisions at compile time, so recognizing a keyword costs one table probe
+// and one memcmp.
+// ---------------------------------------------------------------------------
+
+enum class KeywordValue
+{
+    None,  // no semantic value
+    Line,  // yylval.intVal = yylineno, used by the parser for AST line numbers
+    True,  // BOOLEAN_LITERAL true
+    False  // BOOLEAN_LITERAL false
+};
+
+struct Keyword
+{
+    const char *text;
+    int token;
+    KeywordValue value;
+};
+
+static constexpr Keyword KEYWORDS[] = {
+    {"let", LET, KeywordValue::None},
+    {"if", IF, KeywordValue::Line},
+    {"else", ELSE, KeywordValue::None},
+    {"while", WHILE, KeywordValue::Line},
+    {"for", FOR, KeywordValue::Line},
+    {"return", RETURN, KeywordValue::Line},
+    {"func", FUNC, KeywordValue::Line},
+    {"print", PRINT, KeywordValue::None},
+    {"import", IMPORT, KeywordValue::None},
+    {"int", INT_TYPE, KeywordValue::None},
+    {"float", FLOAT_TYPE, KeywordValue::None},
+    {"bool", BOOL_TYPE, KeywordValue::None},
+    {"string", STRING_TYPE, KeywordValue::None},
+    {"void", VOID_TYPE, KeywordValue::None},
+    {"true", BOOLEAN_LITERAL, KeywordValue::True},
+    {"false", BOOLEAN_LITERAL, KeywordValue::False},
+};
+
+static constexpr int KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+static constexpr size_t KEYWORD_SLOTS = 32;
+static constexpr size_t MIN_KEYWORD_LENGTH = 2;
+static constexpr size_t MAX_KEYWORD_LENGTH = 6;
+
+static constexpr size_t constLength(const char *text)
+{
+    size_t length = 0;
+    while (text[length])
+        ++length;
+    return length;
+}
+
+static constexpr size_t keywordHash(const char *text, size_t length)
+{
+    return (length + 3 * (unsigned char)text[0] + 25 * (unsigned char)text[length - 1]) % KEYWORD_SLOTS;
+}
+
+// Slot -> index into KEYWORDS + 1 (0 for an empty slot) and keyword length
+struct KeywordTable
+{
+    int slots[KEYWORD_SLOTS] = {};
+    size_t lengths[KEYWORD_SLOTS] = {};
+    bool perfect = true;
+};
+
+static constexpr KeywordTable buildKeywordTable()
+{
+    KeywordTable table;
+    for (int i = 0; i < KEYWORD_COUNT; ++i)
+    {
+        size_t length = constLength(KEYWORDS[i].text);
+        size_t slot = keywordHash(KEYWORDS[i].text, length);
+        if (table.slots[slot] || length < MIN_KEYWORD_LENGTH || length > MAX_KEYWORD_LENGTH)
+            table.perfect = false;
+        table.slots[slot] = i + 1;
+        table.lengths[slot] = length;
+    }
+    return table;
+}
+
+static constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+static_assert(KEYWORD_TABLE.perfect, "keyword hash has a collision; pick new multipliers in keywordHash");
+
+static const Keyword *findKeyword(const char *text, size_t length)
+{
+    if (length < MIN_KEYWORD_LENGTH || length > MAX_KEYWORD_LENGTH)
+        return nullptr;
+    size_t slot = keywordHash(text, length);
+    int index = KEYWORD_TABLE.slots[slot];
+    if (!index || KEYWORD_TABLE.lengths[slot] != length || memcmp(KEYWORDS[index - 1].text, text, length) != 0)
+        return nullptr;
+    return &KEYWORDS[index - 1];
+}
+
+// ---------------------------------------------------------------------------
+// Character runs are scanned eight bytes at a time (SWAR): each helper below
+// returns a word with the high bit set in every byte that is in the class.
+// ---------------------------------------------------------------------------
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BAC_SCAN_WORDS 1
+#else
+#define BAC_SCAN_WORDS 0
+#endif
+
+static const uint64_t ONES = 0x0101010101010101ull;
+static const uint64_t LOW7 = 0x7f7f7f7f7f7f7f7full;
+static const uint64_t HIGH = 0x8080808080808080ull;
+
+static inline uint64_t loadWord(const char *p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+static inline uint64_t bytesEqual(uint64_t word, unsigned char c)
+{
+    uint64_t x = word ^ (ONES * c);
+    return ~(((x & LOW7) + LOW7) | x | LOW7);
+}
+
+// Bytes in [lo, hi]; both bounds must be ASCII
+static inline uint64_t bytesInRange(uint64_t word, unsigned char lo, unsigned char hi)
+{
+    uint64_t low = word & LOW7;
+    uint64_t atLeastLo = low + ONES * (128 - lo);
+    uint64_t aboveHi = low + ONES * (127 - hi);
+    return atLeastLo & ~aboveHi & ~word & HIGH;
+}
+
+static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+static inline bool isIdentStart(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+static inline bool isIdentChar(char c) { return isIdentStart(c) || isDigit(c); }
+
+// The input always has zero padding after its last byte, and '\0' belongs to
+// none of these classes, so the scans below stop at the end of the data.
+
+// Skips spaces, tabs, carriage returns and newlines, counting the newlines
+static const char *skipSpace(const char *p, int &lines)
+{
+#if BAC_SCAN_WORDS
+    for (;;)
+    {
+        uint64_t word = loadWord(p);
+        uint64_t newline = bytesEqual(word, '\n');
+        uint64_t space = newline | bytesEqual(word, ' ') | bytesEqual(word, '\t') | bytesEqual(word, '\r');
+        uint64_t other = ~space & HIGH;
+        if (other)
+        {
+            int skipped = __builtin_ctzll(other) / 8;
+            lines += __builtin_popcountll(newline & ((1ull << (8 * skipped)) - 1));
+            return p + skipped;
+        }
+        lines += __builtin_popcountll(newline);
+        p += 8;
+    }
+#else
+    for (; isSpace(*p); ++p)
+        lines += (*p == '\n');
+    return p;
+#endif
+}
+
+static const char *skipDigits(const char *p)
+{
+#if BAC_SCAN_WORDS
+    for (;;)
+    {
+        uint64_t other = ~bytesInRange(loadWord(p), '0', '9') & HIGH;
+        if (other)
+            return p + __builtin_ctzll(other) / 8;
+        p += 8;
+    }
+#else
+    while (isDigit(*p))
+        ++p;
+    return p;
+#endif
+}
+
+static const char *skipIdentifier(const char *p)
+{
+#if BAC_SCAN_WORDS
+    for (;;)
+    {
+        uint64_t word = loadWord(p);
+        // Setting bit 5 folds upper case onto lower case without creating new letters
+        uint64_t ident = bytesInRange(word | (ONES * 0x20), 'a', 'z') | bytesInRange(word, '0', '9') | bytesEqual(word, '_');
+        uint64_t other = ~ident & HIGH;
+        if (other)
+            return p + __builtin_ctzll(other) / 8;
+        p += 8;
+    }
+#else
+    while (isIdentChar(*p))
+        ++p;
+    return p;
+#endif
+}
+
+// First '"' or '\\' in [p, end), or end. String contents may contain '\0'.
+static const char *findQuoteOrEscape(const char *p, const char *end)
+{
+#if BAC_SCAN_WORDS
+    for (; p < end; p += 8)
+    {
+        uint64_t word = loadWord(p);
+        uint64_t found = bytesEqual(word, '"') | bytesEqual(word, '\\');
+        if (found)
+        {
+            const char *hit = p + __builtin_ctzll(found) / 8;
+            return hit < end ? hit : end;
+        }
+    }
+    return end;
+#else
+    while (p < end && *p != '"' && *p != '\\')
+        ++p;
+    return p;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Input buffer. The file is read in chunks; a token that runs past the end of
+// the buffered data is rescanned after the rest of it has been read, so the
+// buffer only ever holds one chunk plus the longest token.
+// ---------------------------------------------------------------------------
+
+static const size_t CHUNK_SIZE = 1 << 16;
+static const size_t PADDING = 16;
+
+static struct
+{
+    FILE *source = nullptr;
+    char *data = nullptr;
+    size_t capacity = 0;
+    char *pos = nullptr;
+    char *end = nullptr;
+    bool eof = false;
+    bool finished = true; // end of input was returned, so the next call starts over
+} input;
+
+static void resetInput(FILE *source)
+{
+    if (!input.data)
+    {
+        input.capacity = CHUNK_SIZE;
+        input.data = static_cast<char *>(malloc(input.capacity + PADDING));
+    }
+    input.source = source;
+    input.pos = input.end = input.data;
+    memset(input.end, 0, PADDING);
+    input.eof = false;
+    input.finished = false;
+}
+
+// Reads more input, keeping everything from `start` on. Updates `start` to its
+// new location; returns false once the source is exhausted.
+static bool refill(char *&start)
+{
+    if (input.eof)
+        return false;
+
+    size_t kept = input.end - start;
+    memmove(input.data, start, kept);
+    size_t wanted = kept > CHUNK_SIZE ? kept : CHUNK_SIZE; // grow geometrically for long tokens
+    if (kept + wanted > input.capacity)
+    {
+        input.capacity = kept + wanted;
+        input.data = static_cast<char *>(realloc(input.data, input.capacity + PADDING));
+    }
+
+    size_t read = fread(input.data + kept, 1, input.capacity - kept, input.source);
+    if (read == 0)
+        input.eof = true;
+
+    start = input.pos = input.data;
+    input.end = input.data + kept + read;
+    memset(input.end, 0, PADDING);
+    return read > 0;
+}
+
+static char *copyText(const char *text, size_t length)
+{
+    char *copy = static_cast<char *>(malloc(length + 1));
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Matches lexer.l's catch-all rule
+static int unknownCharacter(char c)
+{
+    char text[2] = {c, '\0'};
+    reportError(ErrorType::SyntaxError, string("Unknown character: ") + text, yylineno);
+    return INVALID;
+}
+
+// Scans one token starting at `start`. Returns -1 if the token may continue past
+// the buffered data, in which case the caller refills and tries again.
+static int scanToken(char *start, bool more)
+{
+    char *p = start;
+    char c = *p;
+
+    if (isIdentStart(c))
+    {
+        p = const_cast<char *>(skipIdentifier(p + 1));
+        if (p == input.end && more)
+            return -1;
+        input.pos = p;
+
+        size_t length = p - start;
+        if (const Keyword *keyword = findKeyword(start, length))
+        {
+            if (keyword->value == KeywordValue::Line)
+                yylval.intVal = yylineno;
+            else if (keyword->value != KeywordValue::None)
+                yylval.boolean = keyword->value == KeywordValue::True;
+            return keyword->token;
+        }
+        yylval.str = copyText(start, length);
+        return IDENTIFIER;
+    }
+
+    if (isDigit(c))
+    {
+        p = const_cast<char *>(skipDigits(p + 1));
+        int token = INT_LITERAL;
+        if (*p == '.' && p + 1 < input.end && isDigit(p[1]))
+        {
+            p = const_cast<char *>(skipDigits(p + 2));
+            token = FLOAT_LITERAL;
+        }
+        // "12." needs the next byte to decide between a float and 12 followed by '.'
+        if (p + (*p == '.') >= input.end && more)
+            return -1;
+        input.pos = p;
+
+        // Convert in place: the byte after the number is restored afterwards
+        char saved = *p;
+        *p = '\0';
+        if (token == INT_LITERAL)
+            yylval.intVal = atoi(start);
+        else
+            yylval.floatVal = atof(start);
+        *p = saved;
+        return token;
+    }
+
+    if (c == '"')
+    {
+        for (p = start + 1;;)
+        {
+            p = const_cast<char *>(findQuoteOrEscape(p, input.end));
+            if (p == input.end)
+                break;
+            if (*p == '"')
+            {
+                input.pos = p + 1;
+                yylval.str = copyText(start, input.pos - start);
+                return STRING_LITERAL;
+            }
+            // A backslash escapes any character except a newline
+            if (p + 1 == input.end)
+            {
+                if (more)
+                    return -1;
+                break;
+            }
+            if (p[1] == '\n')
+                break;
+            p += 2;
+        }
+        if (p == input.end && more)
+            return -1;
+        input.pos = start + 1;
+        return unknownCharacter(c);
+    }
+
+    // Everything else needs at most one byte of lookahead, except comments
+    if (start + 1 == input.end && more)
+        return -1;
+    char next = start[1];
+    input.pos = start + 1;
+
+    switch (c)
+    {
+    case '/':
+        if (next == '/')
+        {
+            char *newline = static_cast<char *>(memchr(start + 2, '\n', input.end - (start + 2)));
+            if (!newline && more)
+                return -1;
+            input.pos = newline ? newline : input.end;
+            return 0; // comment, no token
+        }
+        if (next == '*')
+        {
+            for (p = start + 2; p < input.end;)
+            {
+                char *star = static_cast<char *>(memchr(p, '*', input.end - p));
+                if (!star || star + 1 == input.end)
+                    break;
+                if (star[1] == '/')
+                {
+                    input.pos = star + 2;
+                    return 0;
+                }
+                p = star + 1;
+            }
+            if (more)
+                return -1;
+        }
+        return DIV;
+    case '=':
+        if (next == '=')
+        {
+            input.pos = start + 2;
+            return EQ;
+        }
+        return ASSIGN;
+    case '!':
+        if (next == '=')
+        {
+            input.pos = start + 2;
+            return NEQ;
+        }
+        return NOT;
+    case '<':
+        if (next == '=')
+        {
+            input.pos = start + 2;
+            return LE;
+        }
+        return LT;
+    case '>':
+        if (next == '=')
+        {
+            input.pos = start + 2;
+            return GE;
+        }
+        return GT;
+    case '&':
+        if (next == '&')
+        {
+            input.pos = start + 2;
+            return AND;
+        }
+        break;
+    case '|':
+        if (next == '|')
+        {
+            input.pos = start + 2;
+            return OR;
+        }
+        break;
+    case '+':
+        return PLUS;
+    case '-':
+        return MINUS;
+    case '*':
+        return MUL;
+    case '%':
+        return MOD;
+    case '(':
+        return LPAREN;
+    case ')':
+        return RPAREN;
+    case '{':
+        return LBRACE;
+    case '}':
+        return RBRACE;
+    case ',':
+        return COMMA;
+    case ';':
+        return SEMICOLON;
+    default:
+        break;
+    }
+    return unknownCharacter(c);
+}
+
+int yylex()
+{
+    // Like Flex, reading continues from yyin after end of input, and a new yyin
+    // (e.g. an imported module being parsed) starts a fresh buffer
+    FILE *source = yyin ? yyin : stdin;
+    if (input.finished || input.source != source)
+        resetInput(source);
+
+    for (;;)
+    {
+        int lines = 0;
+        input.pos = const_cast<char *>(skipSpace(input.pos, lines));
+        yylineno += lines;
+
+        char *start = input.pos;
+        if (start == input.end)
+        {
+            if (!refill(start))
+            {
+                input.finished = true;
+                return 0;
+            }
+            continue;
+        }
+
+        int token = scanToken(start, !input.eof);
+        if (token < 0)
+        {
+            refill(start);
+            continue;
+        }
+        if (token > 0)
+            return token;
+    }
+}
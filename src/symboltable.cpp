@@ -24,6 +24,13 @@ void SymbolTable::exitScope()
 {
     if (currentScope > 0)
     {
+        for (const auto &name : scopes.back())
+        {
+            auto it = bindings.find(name);
+            it->second.pop_back();
+            if (it->second.empty())
+                bindings.erase(it);
+        }
         scopes.pop_back();
         --currentScope;
     }
@@ -33,24 +40,22 @@ void SymbolTable::exitScope()
 // Returns false if symbol already exists in current scope
 bool SymbolTable::declare(const string &name, VarType type, SymbolType symbolType)
 {
-    auto &current = scopes.back();
-    if (current.count(name) > 0)
+    auto &visible = bindings[name];
+    if (!visible.empty() && visible.back()->scopeLevel == currentScope)
         return false;
 
-    current[name] = make_shared<SymbolInfo>(name, type, symbolType, currentScope);
+    visible.push_back(make_shared<SymbolInfo>(name, type, symbolType, currentScope));
+    scopes.back().push_back(name);
     return true;
 }
 
 // Look up a symbol in current and outer scopes
-// Searches from innermost to outermost scope
+// The innermost declaration shadows outer ones
 // Returns nullptr if symbol not found
 shared_ptr<SymbolInfo> SymbolTable::lookup(const string &name)
 {
-    for (int i = currentScope; i >= 0; --i)
-    {
-        auto &scope = scopes[i];
-        if (scope.count(name))
-            return scope[name];
-    }
-    return nullptr;
-}
+    auto it = bindings.find(name);
+    if (it == bindings.end())
+        return nullptr;
+    return it->second.back();
+}
\ No newline at end of file
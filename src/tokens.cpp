@@ -0,0 +1,146 @@
+// Token stream dump and lexer benchmark (--tokens, --lex-bench)
+#include "lexer.h"
+#include "parser.tab.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+#ifdef BAC_HANDWRITTEN_LEXER
+static const char *LEXER_NAME = "hand-written";
+#else
+static const char *LEXER_NAME = "Flex";
+#endif
+
+const char *tokenName(int token)
+{
+    switch (token)
+    {
+    case IDENTIFIER: return "IDENTIFIER";
+    case STRING_LITERAL: return "STRING_LITERAL";
+    case INT_LITERAL: return "INT_LITERAL";
+    case FLOAT_LITERAL: return "FLOAT_LITERAL";
+    case BOOLEAN_LITERAL: return "BOOLEAN_LITERAL";
+    case PRINT: return "PRINT";
+    case IMPORT: return "IMPORT";
+    case IF: return "IF";
+    case WHILE: return "WHILE";
+    case FOR: return "FOR";
+    case RETURN: return "RETURN";
+    case FUNC: return "FUNC";
+    case LET: return "LET";
+    case ELSE: return "ELSE";
+    case INT_TYPE: return "INT_TYPE";
+    case FLOAT_TYPE: return "FLOAT_TYPE";
+    case BOOL_TYPE: return "BOOL_TYPE";
+    case STRING_TYPE: return "STRING_TYPE";
+    case VOID_TYPE: return "VOID_TYPE";
+    case EQ: return "EQ";
+    case NEQ: return "NEQ";
+    case LE: return "LE";
+    case GE: return "GE";
+    case LT: return "LT";
+    case GT: return "GT";
+    case AND: return "AND";
+    case OR: return "OR";
+    case NOT: return "NOT";
+    case PLUS: return "PLUS";
+    case MINUS: return "MINUS";
+    case MUL: return "MUL";
+    case DIV: return "DIV";
+    case MOD: return "MOD";
+    case ASSIGN: return "ASSIGN";
+    case LPAREN: return "LPAREN";
+    case RPAREN: return "RPAREN";
+    case LBRACE: return "LBRACE";
+    case RBRACE: return "RBRACE";
+    case COMMA: return "COMMA";
+    case SEMICOLON: return "SEMICOLON";
+    case INVALID: return "INVALID";
+    default: return "UNKNOWN";
+    }
+}
+
+void dumpTokens(ostream &out)
+{
+    int token;
+    while ((token = yylex()) != 0)
+    {
+        out << yylineno << " " << tokenName(token);
+        switch (token)
+        {
+        case IDENTIFIER:
+        case STRING_LITERAL:
+            out << " " << yylval.str;
+            free(yylval.str);
+            break;
+        case INT_LITERAL:
+        case IF:
+        case WHILE:
+        case FOR:
+        case RETURN:
+        case FUNC:
+            out << " " << yylval.intVal;
+            break;
+        case FLOAT_LITERAL:
+            out << " " << yylval.floatVal;
+            break;
+        case BOOLEAN_LITERAL:
+            out << " " << (yylval.boolean ? "true" : "false");
+            break;
+        default:
+            break;
+        }
+        out << "\n";
+    }
+}
+
+// Lexes the whole file once, freeing strings as the parser would. Returns the token count.
+static long lexFile(const string &path)
+{
+    yyin = fopen(path.c_str(), "r");
+    if (!yyin)
+        return -1;
+    yylineno = 1;
+
+    long count = 0;
+    int token;
+    while ((token = yylex()) != 0)
+    {
+        if (token == IDENTIFIER || token == STRING_LITERAL)
+            free(yylval.str);
+        ++count;
+    }
+
+    fclose(yyin);
+    yyin = nullptr;
+    return count;
+}
+
+bool benchmarkLexer(const string &path)
+{
+    using Clock = chrono::steady_clock;
+
+    long tokens = lexFile(path); // warm-up pass, also brings the file into the page cache
+    if (tokens < 0)
+    {
+        cerr << "❌ Error: Could not open file " << path << "\n";
+        return false;
+    }
+
+    int passes = 0;
+    auto start = Clock::now();
+    chrono::duration<double> elapsed(0);
+    while (passes == 0 || elapsed.count() < 1.0)
+    {
+        lexFile(path);
+        ++passes;
+        elapsed = Clock::now() - start;
+    }
+
+    double seconds = elapsed.count() / passes;
+    cout << "⏱️  " << LEXER_NAME << " lexer: " << tokens << " tokens in " << seconds * 1000 << " ms per pass ("
+         << passes << " passes), " << tokens / seconds / 1e6 << " M tokens/s\n";
+    return true;
+}
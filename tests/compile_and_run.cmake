@@ -0,0 +1,25 @@
+# compile_and_run(<compiler> <source> <expected> [ARGS <flag>...])
+# Runs the compiler on a .bac file, which also builds and runs the program.
+# ARGS are passed to the compiler before the source, e.g. --stream.
+# Fails unless the compiler exits with 0 and, if <expected> is not empty, the
+# program's output contains that text.
+function(compile_and_run compiler source expected)
+    cmake_parse_arguments(PARSE_ARGV 3 RUN "" "" "ARGS")
+    execute_process(
+        COMMAND "${compiler}" ${RUN_ARGS} "${source}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE errors
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Compiler exited with ${result} on ${source} ${RUN_ARGS}\n${output}\n${errors}")
+    endif()
+
+    if(NOT expected STREQUAL "")
+        string(REPLACE "\r\n" "\n" output "${output}")
+        string(FIND "${output}" "${expected}" position)
+        if(position EQUAL -1)
+            message(FATAL_ERROR "Output of ${source} ${RUN_ARGS} does not contain:\n${expected}\n--- got ---\n${output}\n${errors}")
+        endif()
+    endif()
+endfunction()
@@ -0,0 +1,71 @@
+# Builds the compiler with the Flex lexer and with the hand-written one, checks
+# that both produce the same token stream (--tokens) for every example, then
+# reports the speed of each (--lex-bench) on a larger input made from them.
+# Usage: cmake -DSOURCE_DIR=<repo> -DWORK_DIR=<dir> [-DGENERATOR=<cmake generator>]
+#              [-DEXE_SUFFIX=<.exe>] -P lexer_diff.cmake
+
+set(generator_args)
+if(GENERATOR)
+    set(generator_args -G "${GENERATOR}")
+endif()
+
+foreach(lexer flex handwritten)
+    if(lexer STREQUAL "handwritten")
+        set(option ON)
+    else()
+        set(option OFF)
+    endif()
+
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${WORK_DIR}/${lexer}" ${generator_args}
+                -DBAC_HANDWRITTEN_LEXER=${option} -DCMAKE_BUILD_TYPE=Release
+        RESULT_VARIABLE result
+    )
+    if(result EQUAL 0)
+        execute_process(COMMAND ${CMAKE_COMMAND} --build "${WORK_DIR}/${lexer}" RESULT_VARIABLE result)
+    endif()
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Could not build the ${lexer} lexer configuration")
+    endif()
+    set(compiler_${lexer} "${WORK_DIR}/${lexer}/mycompiler${EXE_SUFFIX}")
+endforeach()
+
+# Differential test: tokens, values, line numbers and lexer errors must all match
+file(GLOB examples "${SOURCE_DIR}/examples/*.bac")
+set(corpus "")
+foreach(example ${examples})
+    foreach(lexer flex handwritten)
+        execute_process(
+            COMMAND "${compiler_${lexer}}" --tokens "${example}"
+            OUTPUT_VARIABLE tokens_${lexer}
+            ERROR_VARIABLE errors_${lexer}
+        )
+    endforeach()
+
+    if(NOT tokens_flex STREQUAL tokens_handwritten OR NOT errors_flex STREQUAL errors_handwritten)
+        file(WRITE "${WORK_DIR}/flex.tokens" "${tokens_flex}${errors_flex}")
+        file(WRITE "${WORK_DIR}/handwritten.tokens" "${tokens_handwritten}${errors_handwritten}")
+        message(FATAL_ERROR "Token streams differ for ${example}; "
+                            "see ${WORK_DIR}/flex.tokens and ${WORK_DIR}/handwritten.tokens")
+    endif()
+    message(STATUS "Same tokens: ${example}")
+
+    file(READ "${example}" source)
+    string(APPEND corpus "${source}\n")
+endforeach()
+
+# Benchmark on the examples repeated to a few megabytes
+string(REPEAT "${corpus}" 2000 corpus)
+file(WRITE "${WORK_DIR}/bench.bac" "${corpus}")
+foreach(lexer flex handwritten)
+    execute_process(
+        COMMAND "${compiler_${lexer}}" --lex-bench "${WORK_DIR}/bench.bac"
+        OUTPUT_VARIABLE report
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "--lex-bench failed for the ${lexer} lexer")
+    endif()
+    message(STATUS "${report}")
+endforeach()
@@ -0,0 +1,30 @@
+# Checks that precompiled modules are reused, and rebuilt when a module they
+# import changes: mid.bac folds a call into base.bac at compile time, so
+# editing base.bac must rebuild mid.bac too. app.bac passes a variable so its
+# own call into mid.bac isn't folded and mid.bac's object code is what runs.
+# Usage: cmake -DCOMPILER=<mycompiler> -DWORK_DIR=<dir> -P module_rebuild.cmake
+include(${CMAKE_CURRENT_LIST_DIR}/compile_and_run.cmake)
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+file(WRITE "${WORK_DIR}/mid.bac" "import \"base.bac\";\n\nfunc offset(let n){\n  return sq(3)+n;\n}\n")
+file(WRITE "${WORK_DIR}/app.bac" "import \"mid.bac\";\n\nfunc main(){\n  let n=0;\n  print(\"result: \");\n  print(offset(n));\n  print(\"\\n\");\n}\n")
+
+file(WRITE "${WORK_DIR}/base.bac" "func sq(let x){\n  return x*x;\n}\n")
+compile_and_run("${COMPILER}" "${WORK_DIR}/app.bac" "result: 9\n")
+
+file(WRITE "${WORK_DIR}/base.bac" "func sq(let x){\n  return x*x+1;\n}\n")
+compile_and_run("${COMPILER}" "${WORK_DIR}/app.bac" "result: 10\n")
+
+# Nothing changed since the last build: both modules come from the cache
+execute_process(
+    COMMAND "${COMPILER}" "${WORK_DIR}/app.bac"
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+)
+string(REPLACE "\r\n" "\n" output "${output}")
+if(NOT result EQUAL 0 OR NOT output MATCHES "result: 10\n" OR output MATCHES "Building module")
+    message(FATAL_ERROR "Expected cached modules and result 10 on the third build\n${output}\n${errors}")
+endif()
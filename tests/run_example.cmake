@@ -0,0 +1,8 @@
+# Compiles and runs one example, comparing its output with a .expected file.
+# Usage: cmake -DCOMPILER=<mycompiler> -DSOURCE=<file.bac> -DEXPECTED=<file.expected> [-DARGS=<flags>] -P run_example.cmake
+include(${CMAKE_CURRENT_LIST_DIR}/compile_and_run.cmake)
+
+file(READ "${EXPECTED}" expected)
+string(REPLACE "\r\n" "\n" expected "${expected}")
+string(STRIP "${expected}" expected)
+compile_and_run("${COMPILER}" "${SOURCE}" "${expected}" ARGS ${ARGS})
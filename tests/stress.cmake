@@ -0,0 +1,40 @@
+# Generates deeply nested programs of the given SIZE and checks that they compile
+# and print the right result: long `a+a+...` and `a-a-...` chains, nested
+# parentheses and nested ifs.
+# Usage: cmake -DCOMPILER=<mycompiler> -DSIZE=<n> -DWORK_DIR=<dir> -P stress.cmake
+include(${CMAKE_CURRENT_LIST_DIR}/compile_and_run.cmake)
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+math(EXPR rest "${SIZE} - 1")
+set(prologue "func main(){\n  let a=1;\n")
+set(report "  print(\"result: \");\n  print(b);\n")
+set(epilogue "${report}}\n")
+
+# a+a+...+a
+string(REPEAT "a+" ${rest} terms)
+file(WRITE "${WORK_DIR}/add${SIZE}.bac" "${prologue}  let b=${terms}a;\n${epilogue}")
+compile_and_run("${COMPILER}" "${WORK_DIR}/add${SIZE}.bac" "result: ${SIZE}")
+
+# a-a-...-a
+string(REPEAT "a-" ${rest} terms)
+math(EXPR difference "1 - ${rest}")
+file(WRITE "${WORK_DIR}/sub${SIZE}.bac" "${prologue}  let b=${terms}a;\n${epilogue}")
+compile_and_run("${COMPILER}" "${WORK_DIR}/sub${SIZE}.bac" "result: ${difference}")
+
+# ((((a))))+41
+string(REPEAT "(" ${SIZE} open)
+string(REPEAT ")" ${SIZE} close)
+file(WRITE "${WORK_DIR}/paren${SIZE}.bac" "${prologue}  let b=${open}a${close}+41;\n${epilogue}")
+compile_and_run("${COMPILER}" "${WORK_DIR}/paren${SIZE}.bac" "result: 42")
+
+# if(a<2){ if(a<2){ ... let b=a; ... } }
+string(REPEAT "if(a<2){\n" ${SIZE} open)
+string(REPEAT "}\n" ${SIZE} close)
+file(WRITE "${WORK_DIR}/if${SIZE}.bac" "${prologue}${open}  let b=a;\n${report}${close}}\n")
+if(SIZE GREATER 100000)
+    # gcc's own parser runs out of stack on this many nested C blocks, so only
+    # the compiler itself is checked here
+    compile_and_run("${COMPILER}" "${WORK_DIR}/if${SIZE}.bac" "")
+else()
+    compile_and_run("${COMPILER}" "${WORK_DIR}/if${SIZE}.bac" "result: 1")
+endif()